@@ -0,0 +1,599 @@
+//
+// DiskBlobCache.cpp: Implements the disk store behind EGL_ANDROID_blob_cache.
+//
+// Each entry is a file named after the XXH64 hash of its key, holding an EntryHeader, the key
+// and the value. The key is compared on lookup, so hash collisions are misses. The last use of an
+// entry is its file modification time, which keeps the LRU order across runs.
+//
+
+#include "DiskBlobCache.h"
+
+#include <EGL/eglext.h>
+
+#include "ANGLEShaderProgramVersion.h"
+#include "xxhash.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <system_error>
+#include <unordered_map>
+#include <vector>
+
+#if defined(_WIN32)
+#    ifndef WIN32_LEAN_AND_MEAN
+#        define WIN32_LEAN_AND_MEAN
+#    endif
+#    ifndef NOMINMAX
+#        define NOMINMAX
+#    endif
+#    include <windows.h>
+#else
+#    include <fcntl.h>
+#    include <sys/mman.h>
+#    include <sys/stat.h>
+#    include <unistd.h>
+#endif
+
+namespace godot_angle
+{
+namespace
+{
+
+namespace fs = std::filesystem;
+
+constexpr uint32_t kEntryMagic      = 0x42434144;  // "DACB"
+constexpr char kVersionFileName[]   = "version";
+constexpr char kTempFileExtension[] = ".tmp";
+constexpr size_t kEntryFileNameSize = 16;
+
+struct EntryHeader
+{
+    uint32_t magic;
+    uint32_t keySize;
+    uint64_t valueSize;
+};
+
+uint64_t HashKey(const void *key, size_t keySize)
+{
+    return XXH64(key, keySize, 0);
+}
+
+std::string GetEntryFileName(uint64_t hash)
+{
+    static constexpr char kHexDigits[] = "0123456789abcdef";
+    std::string name(kEntryFileNameSize, '0');
+    for (size_t i = 0; i < kEntryFileNameSize; ++i)
+    {
+        name[kEntryFileNameSize - 1 - i] = kHexDigits[(hash >> (i * 4)) & 0xF];
+    }
+    return name;
+}
+
+bool ParseEntryFileName(const std::string &name, uint64_t *hashOut)
+{
+    if (name.size() != kEntryFileNameSize)
+    {
+        return false;
+    }
+    uint64_t hash = 0;
+    for (char c : name)
+    {
+        uint64_t digit = 0;
+        if (c >= '0' && c <= '9')
+        {
+            digit = c - '0';
+        }
+        else if (c >= 'a' && c <= 'f')
+        {
+            digit = c - 'a' + 10;
+        }
+        else
+        {
+            return false;
+        }
+        hash = (hash << 4) | digit;
+    }
+    *hashOut = hash;
+    return true;
+}
+
+// A read-only mapping of a whole file.
+class MappedFile final
+{
+  public:
+    MappedFile() = default;
+    ~MappedFile() { close(); }
+
+    MappedFile(const MappedFile &)            = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    bool open(const fs::path &path)
+    {
+        close();
+#if defined(_WIN32)
+        HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE,
+                                  nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE)
+        {
+            return false;
+        }
+        LARGE_INTEGER size = {};
+        HANDLE mapping     = nullptr;
+        if (GetFileSizeEx(file, &size) && size.QuadPart > 0)
+        {
+            mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        }
+        CloseHandle(file);
+        if (mapping == nullptr)
+        {
+            return false;
+        }
+        mData = static_cast<const uint8_t *>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+        CloseHandle(mapping);
+        mSize = mData != nullptr ? static_cast<size_t>(size.QuadPart) : 0;
+#else
+        int file = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (file < 0)
+        {
+            return false;
+        }
+        struct stat status = {};
+        if (fstat(file, &status) == 0 && status.st_size > 0)
+        {
+            void *data = mmap(nullptr, status.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+            if (data != MAP_FAILED)
+            {
+                mData = static_cast<const uint8_t *>(data);
+                mSize = static_cast<size_t>(status.st_size);
+            }
+        }
+        ::close(file);
+#endif
+        return mData != nullptr;
+    }
+
+    void close()
+    {
+        if (mData != nullptr)
+        {
+#if defined(_WIN32)
+            UnmapViewOfFile(mData);
+#else
+            munmap(const_cast<uint8_t *>(mData), mSize);
+#endif
+        }
+        mData = nullptr;
+        mSize = 0;
+    }
+
+    const uint8_t *data() const { return mData; }
+    size_t size() const { return mSize; }
+
+  private:
+    const uint8_t *mData = nullptr;
+    size_t mSize         = 0;
+};
+
+struct Chunk
+{
+    const void *data;
+    size_t size;
+};
+
+// Writes the chunks to a temporary file, flushes it to disk and renames it over `path`, so that
+// readers and crashes only ever see the old or the new contents.
+bool WriteFileAtomically(const fs::path &path, std::initializer_list<Chunk> chunks)
+{
+    static std::atomic<uint32_t> sTempCounter{0};
+
+#if defined(_WIN32)
+    const unsigned long processId = GetCurrentProcessId();
+#else
+    const unsigned long processId = static_cast<unsigned long>(getpid());
+#endif
+    fs::path tempPath = path;
+    tempPath += "." + std::to_string(processId) + "." + std::to_string(sTempCounter++) +
+                kTempFileExtension;
+
+    bool written = true;
+#if defined(_WIN32)
+    HANDLE file = CreateFileW(tempPath.c_str(), GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS,
+                              FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        return false;
+    }
+    for (const Chunk &chunk : chunks)
+    {
+        const uint8_t *data = static_cast<const uint8_t *>(chunk.data);
+        size_t remaining    = chunk.size;
+        while (written && remaining > 0)
+        {
+            DWORD count   = 0;
+            DWORD toWrite = static_cast<DWORD>(std::min<size_t>(remaining, 1u << 30));
+            written       = WriteFile(file, data, toWrite, &count, nullptr) && count > 0;
+            data += count;
+            remaining -= count;
+        }
+    }
+    written = written && FlushFileBuffers(file);
+    CloseHandle(file);
+#else
+    int file = ::open(tempPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (file < 0)
+    {
+        return false;
+    }
+    for (const Chunk &chunk : chunks)
+    {
+        const uint8_t *data = static_cast<const uint8_t *>(chunk.data);
+        size_t remaining    = chunk.size;
+        while (written && remaining > 0)
+        {
+            ssize_t count = ::write(file, data, remaining);
+            written       = count > 0;
+            if (written)
+            {
+                data += count;
+                remaining -= count;
+            }
+        }
+    }
+    written = written && fsync(file) == 0;
+    ::close(file);
+#endif
+
+    std::error_code error;
+    if (written)
+    {
+        fs::rename(tempPath, path, error);
+    }
+    if (!written || error)
+    {
+        fs::remove(tempPath, error);
+        return false;
+    }
+    return true;
+}
+
+class DiskBlobCache final
+{
+  public:
+    DiskBlobCache(const fs::path &directory, uint64_t maxSizeBytes)
+        : mDirectory(directory), mMaxSizeBytes(maxSizeBytes)
+    {}
+
+    bool initialize();
+    void put(const void *key, size_t keySize, const void *value, size_t valueSize);
+    size_t get(const void *key, size_t keySize, void *value, size_t valueSize);
+
+  private:
+    struct Entry
+    {
+        uint64_t size;
+        std::list<uint64_t>::iterator lruPosition;
+    };
+
+    void touch(uint64_t hash, Entry *entry);
+    void forget(uint64_t hash);
+    void remove(uint64_t hash);
+    void evictToFit(uint64_t incomingSize);
+    const uint8_t *mapValue(uint64_t hash,
+                            const void *key,
+                            size_t keySize,
+                            size_t *valueSizeOut,
+                            bool *collisionOut);
+
+    fs::path mDirectory;
+    uint64_t mMaxSizeBytes;
+    uint64_t mTotalSizeBytes = 0;
+
+    std::unordered_map<uint64_t, Entry> mEntries;
+    // Least recently used first.
+    std::list<uint64_t> mLRU;
+
+    // ANGLE first asks for the size of a value, then for its contents. The mapping of the last
+    // entry looked up is kept for the second call.
+    MappedFile mLastMapping;
+    uint64_t mLastMappingHash = 0;
+};
+
+bool DiskBlobCache::initialize()
+{
+    std::error_code error;
+    fs::create_directories(mDirectory, error);
+    if (error)
+    {
+        return false;
+    }
+
+    // Binaries of another ANGLE_PROGRAM_VERSION would be rejected by ANGLE on load anyway, so drop
+    // them instead of letting them take up the size budget.
+    std::string version;
+    {
+        std::ifstream versionFile(mDirectory / kVersionFileName, std::ios::binary);
+        version.assign(std::istreambuf_iterator<char>(versionFile),
+                       std::istreambuf_iterator<char>());
+    }
+    const bool versionMatches = version == ANGLE_PROGRAM_VERSION;
+
+    struct ScannedEntry
+    {
+        uint64_t hash;
+        uint64_t size;
+        fs::file_time_type lastUse;
+    };
+    std::vector<ScannedEntry> scanned;
+    const fs::file_time_type now = fs::file_time_type::clock::now();
+
+    for (const fs::directory_entry &file : fs::directory_iterator(mDirectory, error))
+    {
+        const fs::path &path = file.path();
+        uint64_t hash        = 0;
+        std::error_code fileError;
+        if (path.extension() == kTempFileExtension)
+        {
+            // Left behind by a crash, unless another process is writing it right now.
+            if (now - file.last_write_time(fileError) > std::chrono::minutes(10))
+            {
+                fs::remove(path, fileError);
+            }
+        }
+        else if (ParseEntryFileName(path.filename().string(), &hash))
+        {
+            if (!versionMatches)
+            {
+                fs::remove(path, fileError);
+                continue;
+            }
+            uint64_t size              = file.file_size(fileError);
+            fs::file_time_type lastUse = file.last_write_time(fileError);
+            if (!fileError)
+            {
+                scanned.push_back({hash, size, lastUse});
+            }
+        }
+    }
+    if (error)
+    {
+        return false;
+    }
+
+    if (!versionMatches &&
+        !WriteFileAtomically(mDirectory / kVersionFileName,
+                             {{ANGLE_PROGRAM_VERSION, strlen(ANGLE_PROGRAM_VERSION)}}))
+    {
+        return false;
+    }
+
+    std::sort(scanned.begin(), scanned.end(),
+              [](const ScannedEntry &a, const ScannedEntry &b) { return a.lastUse < b.lastUse; });
+    for (const ScannedEntry &entry : scanned)
+    {
+        mLRU.push_back(entry.hash);
+        mEntries[entry.hash] = {entry.size, std::prev(mLRU.end())};
+        mTotalSizeBytes += entry.size;
+    }
+    evictToFit(0);
+    return true;
+}
+
+void DiskBlobCache::touch(uint64_t hash, Entry *entry)
+{
+    mLRU.splice(mLRU.end(), mLRU, entry->lruPosition);
+
+    std::error_code error;
+    fs::last_write_time(mDirectory / GetEntryFileName(hash), fs::file_time_type::clock::now(),
+                        error);
+}
+
+// Drops an entry from the index, leaving its file alone.
+void DiskBlobCache::forget(uint64_t hash)
+{
+    auto iter = mEntries.find(hash);
+    if (iter == mEntries.end())
+    {
+        return;
+    }
+    if (mLastMappingHash == hash)
+    {
+        mLastMapping.close();
+    }
+    mTotalSizeBytes -= iter->second.size;
+    mLRU.erase(iter->second.lruPosition);
+    mEntries.erase(iter);
+}
+
+void DiskBlobCache::remove(uint64_t hash)
+{
+    if (mEntries.count(hash) == 0)
+    {
+        return;
+    }
+    forget(hash);
+
+    std::error_code error;
+    fs::remove(mDirectory / GetEntryFileName(hash), error);
+}
+
+void DiskBlobCache::evictToFit(uint64_t incomingSize)
+{
+    while (!mLRU.empty() && mTotalSizeBytes + incomingSize > mMaxSizeBytes)
+    {
+        remove(mLRU.front());
+    }
+}
+
+void DiskBlobCache::put(const void *key, size_t keySize, const void *value, size_t valueSize)
+{
+    const uint64_t entrySize = sizeof(EntryHeader) + keySize + valueSize;
+    if (entrySize > mMaxSizeBytes)
+    {
+        return;
+    }
+
+    const uint64_t hash = HashKey(key, keySize);
+    // Windows cannot rename over a file which is still mapped.
+    if (mLastMappingHash == hash)
+    {
+        mLastMapping.close();
+    }
+
+    // The new file is renamed over the existing entry, so if writing it fails the existing entry
+    // is still there and still indexed.
+    const EntryHeader header = {kEntryMagic, static_cast<uint32_t>(keySize), valueSize};
+    if (!WriteFileAtomically(mDirectory / GetEntryFileName(hash),
+                             {{&header, sizeof(header)}, {key, keySize}, {value, valueSize}}))
+    {
+        return;
+    }
+    forget(hash);
+    mLRU.push_back(hash);
+    mEntries[hash] = {entrySize, std::prev(mLRU.end())};
+    mTotalSizeBytes += entrySize;
+
+    // The new entry is the most recently used and fits on its own, so it is never evicted here.
+    evictToFit(0);
+}
+
+const uint8_t *DiskBlobCache::mapValue(uint64_t hash,
+                                       const void *key,
+                                       size_t keySize,
+                                       size_t *valueSizeOut,
+                                       bool *collisionOut)
+{
+    *collisionOut = false;
+    if (mLastMapping.data() == nullptr || mLastMappingHash != hash)
+    {
+        mLastMappingHash = hash;
+        if (!mLastMapping.open(mDirectory / GetEntryFileName(hash)))
+        {
+            return nullptr;
+        }
+    }
+
+    const uint8_t *data = mLastMapping.data();
+    const size_t size   = mLastMapping.size();
+    EntryHeader header;
+    if (size < sizeof(header))
+    {
+        return nullptr;
+    }
+    memcpy(&header, data, sizeof(header));
+    if (header.magic != kEntryMagic || size != sizeof(header) + header.keySize + header.valueSize)
+    {
+        return nullptr;
+    }
+    if (header.keySize != keySize || memcmp(data + sizeof(header), key, keySize) != 0)
+    {
+        *collisionOut = true;
+        return nullptr;
+    }
+    *valueSizeOut = static_cast<size_t>(header.valueSize);
+    return data + sizeof(header) + keySize;
+}
+
+size_t DiskBlobCache::get(const void *key, size_t keySize, void *value, size_t valueSize)
+{
+    const uint64_t hash = HashKey(key, keySize);
+    auto iter           = mEntries.find(hash);
+    if (iter == mEntries.end())
+    {
+        return 0;
+    }
+
+    size_t storedSize         = 0;
+    bool collision            = false;
+    const uint8_t *storedData = mapValue(hash, key, keySize, &storedSize, &collision);
+    if (storedData == nullptr)
+    {
+        // Anything but a collision means the file is gone or damaged.
+        if (!collision)
+        {
+            remove(hash);
+        }
+        return 0;
+    }
+
+    if (value != nullptr && valueSize >= storedSize)
+    {
+        memcpy(value, storedData, storedSize);
+        mLastMapping.close();
+        touch(hash, &iter->second);
+    }
+    return storedSize;
+}
+
+// ANGLE may link programs on several threads, so every access goes through gCacheMutex.
+std::mutex gCacheMutex;
+std::unique_ptr<DiskBlobCache> gCache;
+
+void SetBlob(const void *key,
+             EGLsizeiANDROID keySize,
+             const void *value,
+             EGLsizeiANDROID valueSize)
+{
+    std::lock_guard<std::mutex> lock(gCacheMutex);
+    if (gCache && keySize > 0 && valueSize > 0)
+    {
+        gCache->put(key, static_cast<size_t>(keySize), value, static_cast<size_t>(valueSize));
+    }
+}
+
+EGLsizeiANDROID GetBlob(const void *key,
+                        EGLsizeiANDROID keySize,
+                        void *value,
+                        EGLsizeiANDROID valueSize)
+{
+    std::lock_guard<std::mutex> lock(gCacheMutex);
+    if (!gCache || keySize <= 0 || valueSize < 0)
+    {
+        return 0;
+    }
+    return static_cast<EGLsizeiANDROID>(gCache->get(key, static_cast<size_t>(keySize), value,
+                                                    static_cast<size_t>(valueSize)));
+}
+
+}  // anonymous namespace
+
+bool AttachDiskBlobCache(EGLDisplay display, const char *directory, uint64_t maxSizeBytes)
+{
+    const char *extensions = eglQueryString(display, EGL_EXTENSIONS);
+    if (extensions == nullptr || strstr(extensions, "EGL_ANDROID_blob_cache") == nullptr)
+    {
+        return false;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(gCacheMutex);
+        if (!gCache)
+        {
+            auto cache = std::make_unique<DiskBlobCache>(fs::u8path(directory), maxSizeBytes);
+            if (!cache->initialize())
+            {
+                return false;
+            }
+            gCache = std::move(cache);
+        }
+    }
+
+    eglSetBlobCacheFuncsANDROID(display, SetBlob, GetBlob);
+    return eglGetError() == EGL_SUCCESS;
+}
+
+void ShutdownDiskBlobCache()
+{
+    std::lock_guard<std::mutex> lock(gCacheMutex);
+    gCache.reset();
+}
+
+}  // namespace godot_angle
@@ -0,0 +1,42 @@
+//
+// DiskBlobCache.h: Persists ANGLE's program cache to disk through EGL_ANDROID_blob_cache.
+//
+// Once attached to a display, every program ANGLE puts in egl::BlobCache is also written to
+// `directory` as one file per BlobCache key, and looked up there when the in-memory cache misses.
+// Displays created with kDiskBlobCacheDisplayFeatures also put translated shaders there, from
+// gl::MemoryShaderCache, so that shaders skip translation even when their program is not cached.
+// Writes go to a temporary file which is renamed over the entry, so a crash never leaves a
+// partial entry behind. Reads map the entry file. Once the directory grows past `maxSizeBytes`,
+// the least recently used entries are removed. The directory is cleared when it was written by a
+// build with a different ANGLE_PROGRAM_VERSION.
+//
+// EGL_ANDROID_blob_cache callbacks carry no user data, so there is one store per process. It can
+// be attached to several displays.
+//
+
+#ifndef GODOT_SRC_DISK_BLOB_CACHE_H_
+#define GODOT_SRC_DISK_BLOB_CACHE_H_
+
+#include <EGL/egl.h>
+
+#include <cstdint>
+
+namespace godot_angle
+{
+
+// Pass as EGL_FEATURE_OVERRIDES_ENABLED_ANGLE to eglGetPlatformDisplay. The shader cache keys
+// entries by the shader source, its compile options, the context's built-in resources and the
+// translator version, so variants of a shader which differ by a define are separate entries.
+constexpr const char *kDiskBlobCacheDisplayFeatures[] = {"cacheCompiledShader", nullptr};
+
+// Call after eglInitialize, before any program is linked. EGL only lets the callbacks be set once
+// in the lifetime of a display, which outlives eglTerminate in ANGLE. Returns false if the
+// directory cannot be used or the display does not accept the callbacks.
+bool AttachDiskBlobCache(EGLDisplay display, const char *directory, uint64_t maxSizeBytes);
+
+// Releases the store. Displays it was attached to stop persisting programs.
+void ShutdownDiskBlobCache();
+
+}  // namespace godot_angle
+
+#endif  // GODOT_SRC_DISK_BLOB_CACHE_H_
@@ -0,0 +1,655 @@
+//
+// PreprocessorScanner.cpp: Implements the hand-written preprocessor scanner.
+//
+// Every flex rule match, including the pieces of a block comment, goes through match(), which
+// tracks Context::scanLoc and the file and line numbers like YY_USER_ACTION in Tokenizer.l. Input
+// is read through Input::read only when scanning needs the next character, which is when the flex
+// scanner refills its buffer too, so line continuations bump the line number at the same point.
+//
+
+#include "PreprocessorScanner.h"
+
+#include "compiler/preprocessor/DiagnosticsBase.h"
+
+#include <climits>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#    define GODOT_ANGLE_SCANNER_SSE2 1
+#    include <emmintrin.h>
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#    define GODOT_ANGLE_SCANNER_NEON 1
+#    include <arm_neon.h>
+#endif
+#if defined(_MSC_VER) && !defined(__clang__)
+#    include <intrin.h>
+#endif
+
+namespace godot_angle
+{
+namespace
+{
+
+using angle::pp::SourceLocation;
+using angle::pp::Token;
+
+// Read size of the flex scanner, YY_READ_BUF_SIZE.
+constexpr size_t kReadSize = 8192;
+
+// Returned by scanComment when the comment ended without producing a token.
+constexpr int kNoToken = -2;
+
+enum CharClass : unsigned char
+{
+    kIdentifierStart = 1 << 0,  // [_a-zA-Z]
+    kIdentifier      = 1 << 1,  // [_a-zA-Z0-9]
+    kDigit           = 1 << 2,  // [0-9]
+    kNumber          = 1 << 3,  // [_a-zA-Z0-9.], the tail of PP_NUMBER
+    kSpace           = 1 << 4,  // [ \t\v\f]
+    kCommentBody     = 1 << 5,  // [^*\r\n]
+    kLineCommentBody = 1 << 6,  // [^\r\n]
+    kPunctuator      = 1 << 7,  // PUNCTUATOR in Tokenizer.l
+};
+
+constexpr bool IsPunctuator(int c)
+{
+    constexpr char kPunctuators[] = "[]<>(){}.+-/*%^|&~=!:;,?";
+    for (const char *punctuator = kPunctuators; *punctuator != '\0'; ++punctuator)
+    {
+        if (c == *punctuator)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+struct CharClassTable
+{
+    constexpr CharClassTable() : classes()
+    {
+        for (int c = 0; c < 256; ++c)
+        {
+            const bool letter = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_';
+            const bool digit  = c >= '0' && c <= '9';
+            int charClass     = 0;
+            if (letter)
+            {
+                charClass |= kIdentifierStart;
+            }
+            if (letter || digit)
+            {
+                charClass |= kIdentifier | kNumber;
+            }
+            if (digit)
+            {
+                charClass |= kDigit;
+            }
+            if (c == '.')
+            {
+                charClass |= kNumber;
+            }
+            if (c == ' ' || c == '\t' || c == '\v' || c == '\f')
+            {
+                charClass |= kSpace;
+            }
+            if (c != '\r' && c != '\n')
+            {
+                charClass |= c == '*' ? kLineCommentBody : kLineCommentBody | kCommentBody;
+            }
+            if (IsPunctuator(c))
+            {
+                charClass |= kPunctuator;
+            }
+            classes[c] = static_cast<unsigned char>(charClass);
+        }
+    }
+
+    unsigned char classes[256];
+};
+
+constexpr CharClassTable kCharClasses;
+
+bool IsDigit(int c)
+{
+    return c >= '0' && c <= '9';
+}
+
+bool IsOctalDigit(int c)
+{
+    return c >= '0' && c <= '7';
+}
+
+bool IsHexDigit(int c)
+{
+    return IsDigit(c) || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F');
+}
+
+// The operators of Tokenizer.l longer than one character, longest first.
+struct Operator
+{
+    const char *text;
+    int type;
+};
+
+constexpr Operator kOperators[] = {
+    {"<<=", Token::OP_LEFT_ASSIGN}, {">>=", Token::OP_RIGHT_ASSIGN}, {"++", Token::OP_INC},
+    {"--", Token::OP_DEC},          {"<<", Token::OP_LEFT},          {">>", Token::OP_RIGHT},
+    {"<=", Token::OP_LE},           {">=", Token::OP_GE},            {"==", Token::OP_EQ},
+    {"!=", Token::OP_NE},           {"&&", Token::OP_AND},           {"^^", Token::OP_XOR},
+    {"||", Token::OP_OR},           {"+=", Token::OP_ADD_ASSIGN},    {"-=", Token::OP_SUB_ASSIGN},
+    {"*=", Token::OP_MUL_ASSIGN},   {"/=", Token::OP_DIV_ASSIGN},    {"%=", Token::OP_MOD_ASSIGN},
+    {"&=", Token::OP_AND_ASSIGN},   {"^=", Token::OP_XOR_ASSIGN},    {"|=", Token::OP_OR_ASSIGN},
+};
+
+#if defined(GODOT_ANGLE_SCANNER_SSE2)
+
+unsigned int CountTrailingZeros(uint32_t bits)
+{
+#    if defined(_MSC_VER) && !defined(__clang__)
+    unsigned long index = 0;
+    _BitScanForward(&index, bits);
+    return index;
+#    else
+    return __builtin_ctz(bits);
+#    endif
+}
+
+__m128i InRange(__m128i c, char low, char high)
+{
+    // Bytes from 0x80 up compare as negative, so they are never in an ASCII range.
+    return _mm_and_si128(_mm_cmpgt_epi8(c, _mm_set1_epi8(static_cast<char>(low - 1))),
+                         _mm_cmplt_epi8(c, _mm_set1_epi8(static_cast<char>(high + 1))));
+}
+
+__m128i Equal(__m128i c, char value)
+{
+    return _mm_cmpeq_epi8(c, _mm_set1_epi8(value));
+}
+
+template <unsigned char Class>
+__m128i Classify(__m128i c)
+{
+    const __m128i digit = InRange(c, '0', '9');
+    if (Class == kDigit)
+    {
+        return digit;
+    }
+    if (Class == kIdentifier || Class == kNumber)
+    {
+        const __m128i letter = InRange(_mm_or_si128(c, _mm_set1_epi8(0x20)), 'a', 'z');
+        const __m128i identifier = _mm_or_si128(_mm_or_si128(digit, letter), Equal(c, '_'));
+        return Class == kNumber ? _mm_or_si128(identifier, Equal(c, '.')) : identifier;
+    }
+    if (Class == kSpace)
+    {
+        return _mm_or_si128(_mm_or_si128(Equal(c, ' '), Equal(c, '\t')),
+                            _mm_or_si128(Equal(c, '\v'), Equal(c, '\f')));
+    }
+    const __m128i lineEnd = _mm_or_si128(Equal(c, '\r'), Equal(c, '\n'));
+    if (Class == kCommentBody)
+    {
+        return _mm_andnot_si128(_mm_or_si128(lineEnd, Equal(c, '*')), _mm_set1_epi8(-1));
+    }
+    return _mm_andnot_si128(lineEnd, _mm_set1_epi8(-1));
+}
+
+#elif defined(GODOT_ANGLE_SCANNER_NEON)
+
+unsigned int CountTrailingZeros(uint64_t bits)
+{
+#    if defined(_MSC_VER) && !defined(__clang__)
+    unsigned long index = 0;
+    _BitScanForward64(&index, bits);
+    return index;
+#    else
+    return __builtin_ctzll(bits);
+#    endif
+}
+
+uint8x16_t InRange(uint8x16_t c, uint8_t low, uint8_t high)
+{
+    return vcleq_u8(vsubq_u8(c, vdupq_n_u8(low)), vdupq_n_u8(high - low));
+}
+
+uint8x16_t Equal(uint8x16_t c, uint8_t value)
+{
+    return vceqq_u8(c, vdupq_n_u8(value));
+}
+
+template <unsigned char Class>
+uint8x16_t Classify(uint8x16_t c)
+{
+    const uint8x16_t digit = InRange(c, '0', '9');
+    if (Class == kDigit)
+    {
+        return digit;
+    }
+    if (Class == kIdentifier || Class == kNumber)
+    {
+        const uint8x16_t letter     = InRange(vorrq_u8(c, vdupq_n_u8(0x20)), 'a', 'z');
+        const uint8x16_t identifier = vorrq_u8(vorrq_u8(digit, letter), Equal(c, '_'));
+        return Class == kNumber ? vorrq_u8(identifier, Equal(c, '.')) : identifier;
+    }
+    if (Class == kSpace)
+    {
+        return vorrq_u8(vorrq_u8(Equal(c, ' '), Equal(c, '\t')),
+                        vorrq_u8(Equal(c, '\v'), Equal(c, '\f')));
+    }
+    const uint8x16_t lineEnd = vorrq_u8(Equal(c, '\r'), Equal(c, '\n'));
+    if (Class == kCommentBody)
+    {
+        return vmvnq_u8(vorrq_u8(lineEnd, Equal(c, '*')));
+    }
+    return vmvnq_u8(lineEnd);
+}
+
+#endif
+
+// Returns the offset of the first character of data[offset, size) which is not in Class, or size.
+template <unsigned char Class>
+size_t SkipClass(const char *data, size_t offset, size_t size)
+{
+#if defined(GODOT_ANGLE_SCANNER_SSE2)
+    for (; offset + 16 <= size; offset += 16)
+    {
+        const __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + offset));
+        const uint32_t outside =
+            ~static_cast<uint32_t>(_mm_movemask_epi8(Classify<Class>(c))) & 0xFFFF;
+        if (outside != 0)
+        {
+            return offset + CountTrailingZeros(outside);
+        }
+    }
+#elif defined(GODOT_ANGLE_SCANNER_NEON)
+    for (; offset + 16 <= size; offset += 16)
+    {
+        const uint8x16_t c = vld1q_u8(reinterpret_cast<const uint8_t *>(data + offset));
+        // Narrowing by 4 bits leaves one nibble per character.
+        const uint8x8_t narrowed =
+            vshrn_n_u16(vreinterpretq_u16_u8(vmvnq_u8(Classify<Class>(c))), 4);
+        const uint64_t outside = vget_lane_u64(vreinterpret_u64_u8(narrowed), 0);
+        if (outside != 0)
+        {
+            return offset + CountTrailingZeros(outside) / 4;
+        }
+    }
+#endif
+    while (offset < size &&
+           (kCharClasses.classes[static_cast<unsigned char>(data[offset])] & Class) != 0)
+    {
+        ++offset;
+    }
+    return offset;
+}
+
+}  // anonymous namespace
+
+PreprocessorScanner::PreprocessorScanner(angle::pp::Tokenizer::Context *context)
+    : mContext(context), mBegin(0), mEnd(0), mFile(0), mLine(1), mInComment(false)
+{}
+
+void PreprocessorScanner::restart()
+{
+    mBegin = 0;
+    mEnd   = 0;
+}
+
+void PreprocessorScanner::lex(Token *token, size_t maxTokenSize)
+{
+    int tokenType = scan(&token->text, &token->location);
+
+    if (tokenType == Token::GOT_ERROR)
+    {
+        mContext->diagnostics->report(angle::pp::Diagnostics::PP_TOKENIZER_ERROR,
+                                      token->location, token->text);
+        token->type = Token::LAST;
+    }
+    else
+    {
+        token->type = tokenType;
+    }
+    if (token->text.size() > maxTokenSize)
+    {
+        mContext->diagnostics->report(angle::pp::Diagnostics::PP_TOKEN_TOO_LONG, token->location,
+                                      token->text);
+        token->text.erase(maxTokenSize);
+    }
+
+    token->flags = 0;
+
+    token->setAtStartOfLine(mContext->lineStart);
+    mContext->lineStart = token->type == '\n';
+
+    token->setHasLeadingSpace(mContext->leadingSpace);
+    mContext->leadingSpace = false;
+}
+
+int PreprocessorScanner::scan(std::string *text, SourceLocation *location)
+{
+    if (mInComment)
+    {
+        int type = scanComment(text, location);
+        if (type != kNoToken)
+        {
+            return type;
+        }
+    }
+
+    while (true)
+    {
+        const int c = peek(0);
+        if (c < 0)
+        {
+            return scanEnd(text, location);
+        }
+        const unsigned char charClass = kCharClasses.classes[c];
+
+        if (charClass & kIdentifierStart)
+        {
+            return makeToken(Token::IDENTIFIER, skip<kIdentifier>(1), text, location);
+        }
+        if ((charClass & kDigit) || (c == '.' && IsDigit(peek(1))))
+        {
+            return scanNumber(text, location);
+        }
+        if (charClass & kSpace)
+        {
+            match(skip<kSpace>(1), location);
+            mContext->leadingSpace = true;
+            continue;
+        }
+        if (c == '\n' || c == '\r')
+        {
+            match(c == '\r' && peek(1) == '\n' ? 2 : 1, location);
+            if (mLine == INT_MAX)
+            {
+                *text = "Integer overflow on line number";
+                return Token::GOT_ERROR;
+            }
+            ++mLine;
+            text->assign(1, '\n');
+            return '\n';
+        }
+        if (c == '/' && peek(1) == '/')
+        {
+            // Line comments are dropped without setting leadingSpace, like in Tokenizer.l.
+            match(skip<kLineCommentBody>(2), location);
+            continue;
+        }
+        if (c == '/' && peek(1) == '*')
+        {
+            match(2, location);
+            mInComment = true;
+            int type   = scanComment(text, location);
+            if (type != kNoToken)
+            {
+                return type;
+            }
+            continue;
+        }
+        if (c == '#')
+        {
+            // # is only valid at start of line for preprocessor directives.
+            return makeToken(mContext->lineStart ? Token::PP_HASH : Token::PP_OTHER, 1, text,
+                         location);
+        }
+        if (charClass & kPunctuator)
+        {
+            for (const Operator &op : kOperators)
+            {
+                size_t length = 0;
+                while (op.text[length] != '\0' && peek(length) == op.text[length])
+                {
+                    ++length;
+                }
+                if (op.text[length] == '\0')
+                {
+                    return makeToken(op.type, length, text, location);
+                }
+            }
+            return makeToken(c, 1, text, location);
+        }
+        return makeToken(Token::PP_OTHER, 1, text, location);
+    }
+}
+
+int PreprocessorScanner::scanComment(std::string *text, SourceLocation *location)
+{
+    // Line breaks are counted, not returned. The comment is replaced by a single space.
+    while (true)
+    {
+        const int c = peek(0);
+        if (c < 0)
+        {
+            return scanEnd(text, location);
+        }
+        if (c == '*')
+        {
+            if (peek(1) == '/')
+            {
+                match(2, location);
+                mContext->leadingSpace = true;
+                mInComment             = false;
+                return kNoToken;
+            }
+            match(1, location);
+        }
+        else if (c == '\n' || c == '\r')
+        {
+            match(c == '\r' && peek(1) == '\n' ? 2 : 1, location);
+            if (mLine == INT_MAX)
+            {
+                *text = "Integer overflow on line number";
+                return Token::GOT_ERROR;
+            }
+            ++mLine;
+        }
+        else
+        {
+            match(skip<kCommentBody>(1), location);
+        }
+    }
+}
+
+int PreprocessorScanner::scanNumber(std::string *text, SourceLocation *location)
+{
+    // Tokenizer.l has separate rules for integers, floats and PP_NUMBER, which catches everything
+    // else starting like a number. Flex takes the longest match, and the earlier rule on a tie.
+    const int first       = peek(0);
+    const size_t ppLength = skip<kNumber>(first == '.' ? 2 : 1);
+    size_t intLength      = 0;
+    if (first == '0')
+    {
+        const int x = peek(1);
+        if ((x == 'x' || x == 'X') && IsHexDigit(peek(2)))
+        {
+            intLength = 3;
+            while (IsHexDigit(peek(intLength)))
+            {
+                ++intLength;
+            }
+        }
+        else
+        {
+            intLength = 1;
+            while (IsOctalDigit(peek(intLength)))
+            {
+                ++intLength;
+            }
+        }
+    }
+    else if (first != '.')
+    {
+        intLength = skip<kDigit>(1);
+    }
+    // Both the constant and the rule take an optional u suffix.
+    for (int suffix = 0; intLength > 0 && suffix < 2; ++suffix)
+    {
+        const int u = peek(intLength);
+        if (u != 'u' && u != 'U')
+        {
+            break;
+        }
+        ++intLength;
+    }
+
+    const size_t digits = first == '.' ? 0 : skip<kDigit>(0);
+    size_t floatLength  = 0;
+    if (peek(digits) == '.')
+    {
+        const size_t fraction = skip<kDigit>(digits + 1);
+        if (digits > 0 || fraction > digits + 1)
+        {
+            floatLength = fraction;
+        }
+    }
+    const size_t mantissa = floatLength > 0 ? floatLength : digits;
+    size_t exponent       = 0;
+    const int e           = peek(mantissa);
+    if (mantissa > 0 && (e == 'e' || e == 'E'))
+    {
+        size_t exponentDigits = mantissa + 1;
+        const int sign        = peek(exponentDigits);
+        if (sign == '+' || sign == '-')
+        {
+            ++exponentDigits;
+        }
+        if (IsDigit(peek(exponentDigits)))
+        {
+            exponent = skip<kDigit>(exponentDigits);
+        }
+    }
+    // Digits alone are only a float with an exponent.
+    if (exponent > 0)
+    {
+        floatLength = exponent;
+    }
+    if (floatLength > 0)
+    {
+        const int f = peek(floatLength);
+        if (f == 'f' || f == 'F')
+        {
+            ++floatLength;
+        }
+    }
+
+    if (intLength > 0 && intLength >= floatLength && intLength >= ppLength)
+    {
+        return makeToken(Token::CONST_INT, intLength, text, location);
+    }
+    if (floatLength > 0 && floatLength >= ppLength)
+    {
+        return makeToken(Token::CONST_FLOAT, floatLength, text, location);
+    }
+    return makeToken(Token::PP_NUMBER, ppLength, text, location);
+}
+
+int PreprocessorScanner::scanEnd(std::string *text, SourceLocation *location)
+{
+    // Like the <<EOF>> rule, which does not go through YY_USER_ACTION.
+    const angle::pp::Input &input       = mContext->input;
+    angle::pp::Input::Location &scanLoc = mContext->scanLoc;
+    const size_t sIndexMax              = input.count() ? input.count() - 1 : 0;
+    if (scanLoc.sIndex != sIndexMax)
+    {
+        // Only reached with empty strings at the end of the input.
+        scanLoc.sIndex = sIndexMax;
+        scanLoc.cIndex = 0;
+        mFile          = static_cast<int>(sIndexMax);
+        mLine          = 1;
+    }
+    location->file = mFile;
+    location->line = mLine;
+    text->clear();
+
+    // Line number overflows fake EOFs to exit early.
+    if (mLine == INT_MAX)
+    {
+        mContext->diagnostics->report(angle::pp::Diagnostics::PP_TOKENIZER_ERROR, *location,
+                                      "Integer overflow on line number");
+    }
+    else if (mInComment)
+    {
+        mContext->diagnostics->report(angle::pp::Diagnostics::PP_EOF_IN_COMMENT, *location,
+                                      "EOF while in a comment");
+    }
+    return Token::LAST;
+}
+
+int PreprocessorScanner::peek(size_t offset)
+{
+    if (offset >= mEnd - mBegin && fill(offset + 1) <= offset)
+    {
+        return -1;
+    }
+    return static_cast<unsigned char>(mBuffer[mBegin + offset]);
+}
+
+template <unsigned char CharClass>
+size_t PreprocessorScanner::skip(size_t offset)
+{
+    while (true)
+    {
+        const size_t size = mEnd - mBegin;
+        offset            = SkipClass<CharClass>(mBuffer.data() + mBegin, offset, size);
+        if (offset < size || fill(offset + 1) <= offset)
+        {
+            return offset;
+        }
+    }
+}
+
+size_t PreprocessorScanner::fill(size_t size)
+{
+    while (mEnd - mBegin < size)
+    {
+        if (mBegin > 0)
+        {
+            // Only the match being scanned is left, move it to the front.
+            memmove(mBuffer.data(), mBuffer.data() + mBegin, mEnd - mBegin);
+            mEnd -= mBegin;
+            mBegin = 0;
+        }
+        if (mBuffer.size() < mEnd + kReadSize)
+        {
+            mBuffer.resize(mEnd + kReadSize);
+        }
+        size_t read = mContext->input.read(mBuffer.data() + mEnd, kReadSize, &mLine);
+        if (read == 0)
+        {
+            break;
+        }
+        mEnd += read;
+    }
+    return mEnd - mBegin;
+}
+
+void PreprocessorScanner::match(size_t length, SourceLocation *location)
+{
+    const angle::pp::Input &input       = mContext->input;
+    angle::pp::Input::Location &scanLoc = mContext->scanLoc;
+    while (scanLoc.sIndex < input.count() && scanLoc.cIndex >= input.length(scanLoc.sIndex))
+    {
+        scanLoc.cIndex -= input.length(scanLoc.sIndex++);
+        ++mFile;
+        mLine = 1;
+    }
+    location->file = mFile;
+    location->line = mLine;
+    scanLoc.cIndex += length;
+    mBegin += length;
+}
+
+int PreprocessorScanner::makeToken(int type,
+                                   size_t length,
+                                   std::string *text,
+                                   SourceLocation *location)
+{
+    text->assign(mBuffer.data() + mBegin, length);
+    match(length, location);
+    return type;
+}
+
+}  // namespace godot_angle
@@ -0,0 +1,72 @@
+//
+// PreprocessorScanner.h: Hand-written scanner behind angle::pp::Tokenizer, in place of the flex
+// generated one from Tokenizer.l.
+//
+// It follows the rules of Tokenizer.l, including the flex longest match between the number rules,
+// and keeps its state in the same Tokenizer::Context, so tokens, locations and diagnostics are the
+// same. Identifiers, numbers, whitespace and comment bodies are classified 16 characters at a time
+// with SSE2 or NEON where available. Token text is assigned into the Token's string, so a Token
+// reused across lex() calls keeps its capacity.
+//
+
+#ifndef GODOT_SRC_PREPROCESSOR_SCANNER_H_
+#define GODOT_SRC_PREPROCESSOR_SCANNER_H_
+
+#include "compiler/preprocessor/Token.h"
+#include "compiler/preprocessor/Tokenizer.h"
+
+#include <string>
+#include <vector>
+
+namespace godot_angle
+{
+
+class PreprocessorScanner
+{
+  public:
+    explicit PreprocessorScanner(angle::pp::Tokenizer::Context *context);
+
+    // Drops the buffered input, to scan context->input again after it was replaced. Like
+    // yyrestart, the file and line numbers are kept, and so is an unterminated block comment.
+    void restart();
+
+    void setFileNumber(int file) { mFile = file; }
+    void setLineNumber(int line) { mLine = line; }
+
+    // Same as angle::pp::Tokenizer::lex.
+    void lex(angle::pp::Token *token, size_t maxTokenSize);
+
+  private:
+    // Returns the type of the next token, like the flex generated pplex.
+    int scan(std::string *text, angle::pp::SourceLocation *location);
+    int scanComment(std::string *text, angle::pp::SourceLocation *location);
+    int scanNumber(std::string *text, angle::pp::SourceLocation *location);
+    int scanEnd(std::string *text, angle::pp::SourceLocation *location);
+
+    // Returns the character `offset` characters into the unscanned input, or -1 past its end.
+    int peek(size_t offset);
+    // Returns the offset of the first character from `offset` on which is not in CharClass.
+    template <unsigned char CharClass>
+    size_t skip(size_t offset);
+    // Reads input until `size` characters are buffered, returns how many are.
+    size_t fill(size_t size);
+
+    // Consumes `length` characters as one flex rule match, and sets `location` to its start.
+    void match(size_t length, angle::pp::SourceLocation *location);
+    int makeToken(int type,
+                  size_t length,
+                  std::string *text,
+                  angle::pp::SourceLocation *location);
+
+    angle::pp::Tokenizer::Context *mContext;
+    std::vector<char> mBuffer;
+    size_t mBegin;
+    size_t mEnd;
+    int mFile;
+    int mLine;
+    bool mInComment;
+};
+
+}  // namespace godot_angle
+
+#endif  // GODOT_SRC_PREPROCESSOR_SCANNER_H_
@@ -0,0 +1,88 @@
+//
+// PreprocessorTokenizer.cpp: angle::pp::Tokenizer on top of godot_angle::PreprocessorScanner.
+// Built in place of preprocessor_lex_autogen.cpp, which defines these methods around the flex
+// scanner, with `fast_pp_tokenizer=yes`.
+//
+
+#include "compiler/preprocessor/Tokenizer.h"
+
+#include "common/debug.h"
+
+#include "PreprocessorScanner.h"
+
+namespace angle
+{
+namespace pp
+{
+namespace
+{
+
+godot_angle::PreprocessorScanner *GetScanner(void *handle)
+{
+    ASSERT(handle != nullptr);
+    return static_cast<godot_angle::PreprocessorScanner *>(handle);
+}
+
+}  // anonymous namespace
+
+Tokenizer::Tokenizer(Diagnostics *diagnostics) : mHandle(nullptr), mMaxTokenSize(256)
+{
+    mContext.diagnostics  = diagnostics;
+    mContext.leadingSpace = false;
+    mContext.lineStart    = true;
+}
+
+Tokenizer::~Tokenizer()
+{
+    destroyScanner();
+}
+
+bool Tokenizer::init(size_t count, const char *const string[], const int length[])
+{
+    if ((count > 0) && (string == nullptr))
+    {
+        return false;
+    }
+
+    mContext.input = Input(count, string, length);
+    return initScanner();
+}
+
+void Tokenizer::setFileNumber(int file)
+{
+    GetScanner(mHandle)->setFileNumber(file);
+}
+
+void Tokenizer::setLineNumber(int line)
+{
+    GetScanner(mHandle)->setLineNumber(line);
+}
+
+void Tokenizer::setMaxTokenSize(size_t maxTokenSize)
+{
+    mMaxTokenSize = maxTokenSize;
+}
+
+void Tokenizer::lex(Token *token)
+{
+    GetScanner(mHandle)->lex(token, mMaxTokenSize);
+}
+
+bool Tokenizer::initScanner()
+{
+    if (mHandle == nullptr)
+    {
+        mHandle = new godot_angle::PreprocessorScanner(&mContext);
+    }
+    GetScanner(mHandle)->restart();
+    return true;
+}
+
+void Tokenizer::destroyScanner()
+{
+    delete static_cast<godot_angle::PreprocessorScanner *>(mHandle);
+    mHandle = nullptr;
+}
+
+}  // namespace pp
+}  // namespace angle
@@ -0,0 +1,121 @@
+//
+// ProgramBatch.cpp: Implements the batch program compile helper.
+//
+
+#include "ProgramBatch.h"
+
+#include <GLES2/gl2ext.h>
+
+#include <cstring>
+
+namespace godot_angle
+{
+namespace
+{
+
+bool HasExtension(const char *name)
+{
+    GLint count = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+    for (GLint i = 0; i < count; ++i)
+    {
+        const char *extension =
+            reinterpret_cast<const char *>(glGetStringi(GL_EXTENSIONS, static_cast<GLuint>(i)));
+        if (extension != nullptr && strcmp(extension, name) == 0)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+GLuint CreateShader(GLenum type, const char *source)
+{
+    GLuint shader = glCreateShader(type);
+    glShaderSource(shader, 1, &source, nullptr);
+    glCompileShader(shader);
+    return shader;
+}
+
+}  // anonymous namespace
+
+ProgramBatch::ProgramBatch(size_t maxPending)
+    : mParallelCompile(HasExtension("GL_KHR_parallel_shader_compile")), mMaxPending(maxPending)
+{}
+
+ProgramBatch::~ProgramBatch()
+{
+    for (GLuint program : mPrograms)
+    {
+        glDeleteProgram(program);
+    }
+}
+
+GLuint ProgramBatch::add(const char *vertexSource, const char *fragmentSource)
+{
+    if (mMaxPending > 0 && mPending.size() >= mMaxPending && poll() >= mMaxPending)
+    {
+        // Querying the link status blocks until the link is done.
+        GLint linked = GL_FALSE;
+        glGetProgramiv(mPending.front(), GL_LINK_STATUS, &linked);
+        mPending.erase(mPending.begin());
+    }
+
+    GLuint vertex   = CreateShader(GL_VERTEX_SHADER, vertexSource);
+    GLuint fragment = CreateShader(GL_FRAGMENT_SHADER, fragmentSource);
+    GLuint program  = glCreateProgram();
+    glAttachShader(program, vertex);
+    glAttachShader(program, fragment);
+    glLinkProgram(program);
+
+    // The shaders stay alive while attached, deleting them only drops the names.
+    glDeleteShader(vertex);
+    glDeleteShader(fragment);
+
+    mPrograms.push_back(program);
+    if (mParallelCompile)
+    {
+        mPending.push_back(program);
+    }
+    return program;
+}
+
+size_t ProgramBatch::poll()
+{
+    // Work is handed out in submission order, so later programs are rarely done before earlier
+    // ones. Stopping at the first one still running saves querying every pending program.
+    size_t completeCount = 0;
+    for (GLuint program : mPending)
+    {
+        GLint complete = GL_FALSE;
+        glGetProgramiv(program, GL_COMPLETION_STATUS_KHR, &complete);
+        if (complete == GL_FALSE)
+        {
+            break;
+        }
+        ++completeCount;
+    }
+    mPending.erase(mPending.begin(), mPending.begin() + completeCount);
+    return mPending.size();
+}
+
+void ProgramBatch::wait()
+{
+    // Querying the link status blocks until the link is done.
+    for (GLuint program : mPending)
+    {
+        GLint linked = GL_FALSE;
+        glGetProgramiv(program, GL_LINK_STATUS, &linked);
+    }
+    mPending.clear();
+}
+
+std::vector<GLuint> ProgramBatch::release()
+{
+    mPending.clear();
+    std::vector<GLuint> programs;
+    programs.swap(mPrograms);
+    return programs;
+}
+
+}  // namespace godot_angle
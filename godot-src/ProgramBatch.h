@@ -0,0 +1,62 @@
+//
+// ProgramBatch.h: Compiles and links many programs on ANGLE's worker threads.
+//
+// With GL_KHR_parallel_shader_compile, glCompileShader and glLinkProgram only queue work on the
+// context's WorkerThreadPool, and ANGLE hands each compile task its own translator instance.
+// ProgramBatch queues a whole set of programs that way before anything waits on them, then
+// reports completion through GL_COMPLETION_STATUS_KHR like a fence: poll() never blocks, wait()
+// does. With `maxPending`, add() first waits for the oldest program once that many are still
+// compiling or linking, which bounds how much of the worker pool the batch keeps busy.
+//
+// Without the extension the same calls are made, but each program finishes before add() returns.
+// It is built into libEGL, so it comes with the archives Godot links.
+//
+
+#ifndef GODOT_SRC_PROGRAM_BATCH_H_
+#define GODOT_SRC_PROGRAM_BATCH_H_
+
+#include <GLES3/gl3.h>
+
+#include <cstddef>
+#include <vector>
+
+namespace godot_angle
+{
+
+class ProgramBatch final
+{
+  public:
+    // Must be created with the context which will use the programs current. A `maxPending` of zero
+    // queues every program without waiting.
+    explicit ProgramBatch(size_t maxPending = 0);
+    // Deletes the programs which were not released.
+    ~ProgramBatch();
+
+    ProgramBatch(const ProgramBatch &)            = delete;
+    ProgramBatch &operator=(const ProgramBatch &) = delete;
+
+    // Queues compiling both shaders and linking them. The returned program can be used once the
+    // batch is complete, and has to be checked with GL_LINK_STATUS like any other.
+    GLuint add(const char *vertexSource, const char *fragmentSource);
+
+    // Returns the number of programs which may still be compiling or linking, without blocking.
+    // Programs are checked in the order they were added, up to the first one still running.
+    size_t poll();
+    // Blocks until every queued program is linked or failed to.
+    void wait();
+    bool isComplete() { return poll() == 0; }
+
+    // Hands the programs over to the caller, who deletes them from now on.
+    std::vector<GLuint> release();
+
+  private:
+    bool mParallelCompile = false;
+    size_t mMaxPending    = 0;
+    std::vector<GLuint> mPrograms;
+    // Programs which were not seen complete yet, in the order they were added.
+    std::vector<GLuint> mPending;
+};
+
+}  // namespace godot_angle
+
+#endif  // GODOT_SRC_PROGRAM_BATCH_H_
@@ -0,0 +1,36 @@
+import sys
+
+from SCons.Variables import BoolVariable
+
+
+def options(opts):
+    opts.Add(BoolVariable("use_llvm", "Use the LLVM compiler", False))
+
+
+def exists(env):
+    return sys.platform.startswith("linux")
+
+
+def generate(env):
+    if env["arch"] not in ("x86_64", "x86_32", "arm64", "arm32", "rv64", "ppc64"):
+        raise ValueError("Unsupported CPU architecture for Linux: " + env["arch"] + ". Exiting.")
+
+    if env["use_llvm"]:
+        env["CC"] = "clang"
+        env["CXX"] = "clang++"
+        env["AR"] = "llvm-ar"
+        env["RANLIB"] = "llvm-ranlib"
+
+    if env["arch"] == "x86_64":
+        env.Append(CCFLAGS=["-m64", "-march=x86-64"])
+        env.Append(LINKFLAGS=["-m64", "-march=x86-64"])
+    elif env["arch"] == "x86_32":
+        env.Append(CCFLAGS=["-m32", "-march=i686"])
+        env.Append(LINKFLAGS=["-m32", "-march=i686"])
+
+    # The archives end up linked into position independent executables.
+    env.Append(CCFLAGS=["-fPIC", "-pthread"])
+    env.Append(LINKFLAGS=["-pthread"])
+    env.Append(LIBS=["dl", "pthread"])
+
+    env.Append(CPPDEFINES=["LINUXBSD_ENABLED", "UNIX_ENABLED"])
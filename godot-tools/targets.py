@@ -1,3 +1,7 @@
+import os
+import re
+import subprocess
+
 from SCons.Script import ARGUMENTS
 from SCons.Variables import BoolVariable, EnumVariable
 from SCons.Variables.BoolVariable import _text2bool
@@ -20,16 +24,137 @@ def options(opts):
             "optimize",
             "The desired optimization flags",
             "speed_trace",
-            ("none", "custom", "debug", "speed", "speed_trace", "size"),
+            ("none", "custom", "debug", "speed", "speed_trace", "size", "pgo_generate", "pgo_use"),
         )
     )
     opts.Add(BoolVariable("debug_symbols", "Build with debugging symbols", True))
+    opts.Add(
+        EnumVariable(
+            "lto",
+            "Link-time optimization, the archives then contain bitcode and must be linked with LTO enabled too",
+            "none",
+            ("none", "thin", "full"),
+        )
+    )
+    opts.Add("pgo_dir", "Directory holding the profile data for `optimize=pgo_generate` and `optimize=pgo_use`", "pgo")
 
 
 def exists(env):
     return True
 
 
+def is_clang(env):
+    return "clang" in os.path.basename(env["CXX"])
+
+
+def get_angle_commit(env):
+    commit_header = env.File("#godot-angle/angle_commit.h").abspath
+    if not os.path.isfile(commit_header):
+        raise ValueError("Missing %s, run update_angle.sh before building with PGO." % commit_header)
+    with open(commit_header, "r") as f:
+        match = re.search(r'#define ANGLE_COMMIT_HASH "([^"]*)"', f.read())
+    return match.group(1) if match else "unknown-hash"
+
+
+def get_compiler_version(env):
+    if env.get("is_msvc", False):
+        return "msvc %s" % env.get("MSVC_VERSION", "unknown")
+    try:
+        version = subprocess.check_output(env.subst("$CXX").split() + ["--version"], universal_newlines=True)
+    except (subprocess.CalledProcessError, OSError):
+        return os.path.basename(env["CXX"])
+    return version.splitlines()[0].strip() if version else os.path.basename(env["CXX"])
+
+
+def get_pgo_stamp(env):
+    # Profiles are only valid for the ANGLE revision, target and compiler that produced them.
+    return "%s %s %s %s\n" % (get_angle_commit(env), env["platform"], env["arch"], get_compiler_version(env))
+
+
+def setup_lto(env):
+    if env.get("is_msvc", False):
+        # MSVC has a single LTCG mode, the consumer link must use /LTCG.
+        env.AppendUnique(CCFLAGS=["/GL"])
+        env.AppendUnique(ARFLAGS=["/LTCG"])
+        env.AppendUnique(LINKFLAGS=["/LTCG"])
+    elif is_clang(env):
+        lto_flag = "-flto=thin" if env["lto"] == "thin" else "-flto"
+        if env["platform"] != "macos" and env["platform"] != "ios":
+            # Bitcode objects need the LLVM archiver to get a symbol index, GNU ar has no LLVM
+            # plugin. Apple's ar reads bitcode through libLTO already.
+            llvm_dir = os.path.dirname(env["AR"])
+            env["AR"] = os.path.join(llvm_dir, "llvm-ar")
+            env["RANLIB"] = os.path.join(llvm_dir, "llvm-ranlib")
+        env.Append(CCFLAGS=[lto_flag])
+        env.Append(LINKFLAGS=[lto_flag])
+    else:
+        if env["lto"] == "thin":
+            print("ThinLTO is only supported by LLVM, using full LTO instead.")
+        # Slim LTO objects need the plugin-aware archiver to get a symbol index.
+        if os.path.basename(env["AR"]) == "ar":
+            env["AR"] = "gcc-ar"
+            env["RANLIB"] = "gcc-ranlib"
+        env.Append(CCFLAGS=["-flto=auto", "-fno-fat-lto-objects"])
+        env.Append(LINKFLAGS=["-flto=auto"])
+
+
+def setup_pgo(env):
+    pgo_dir = env["pgo_dir"] if os.path.isabs(env["pgo_dir"]) else env.Dir("#" + env["pgo_dir"]).abspath
+    stamp_path = os.path.join(pgo_dir, "profile.stamp")
+    stamp = get_pgo_stamp(env)
+
+    if env["optimize"] == "pgo_generate":
+        # The stamp only becomes valid once pgo_train has run to completion and renamed it, so
+        # profiles from an earlier or failed training run are never taken for current ones.
+        os.makedirs(pgo_dir, exist_ok=True)
+        if os.path.isfile(stamp_path):
+            os.remove(stamp_path)
+        with open(stamp_path + ".pending", "w") as f:
+            f.write(stamp)
+    else:
+        if not os.path.isfile(stamp_path):
+            raise ValueError(
+                "No profile data in %s, build pgo_train with optimize=pgo_generate and run it to completion first."
+                % pgo_dir
+            )
+        with open(stamp_path, "r") as f:
+            if f.read() != stamp:
+                raise ValueError(
+                    "Profile data in %s is stale (recorded for a different ANGLE revision, target or compiler), regenerate it with optimize=pgo_generate."
+                    % pgo_dir
+                )
+
+    if env.get("is_msvc", False):
+        # MSVC applies profiles at link time, so the final link (the training driver here, Godot
+        # for the shipped archives) must pass /LTCG with /GENPROFILE or /USEPROFILE too.
+        pgd = os.path.join(pgo_dir, "angle.pgd")
+        env.AppendUnique(CCFLAGS=["/GL"])
+        env.AppendUnique(ARFLAGS=["/LTCG"])
+        if env["optimize"] == "pgo_generate":
+            env.Append(LINKFLAGS=["/LTCG", "/GENPROFILE:PGD=" + pgd])
+        else:
+            env.Append(LINKFLAGS=["/LTCG", "/USEPROFILE:PGD=" + pgd])
+    elif is_clang(env):
+        if env["optimize"] == "pgo_generate":
+            env.Append(CCFLAGS=["-fprofile-generate=" + pgo_dir])
+            env.Append(LINKFLAGS=["-fprofile-generate=" + pgo_dir])
+        else:
+            # Raw profiles have to be merged first: `llvm-profdata merge -o <pgo_dir>/default.profdata <pgo_dir>/*.profraw`.
+            profdata = os.path.join(pgo_dir, "default.profdata")
+            if not os.path.isfile(profdata):
+                raise ValueError("Missing %s, merge the raw profiles with llvm-profdata first." % profdata)
+            env.Append(CCFLAGS=["-fprofile-use=" + profdata])
+            env.Append(CCFLAGS=["-Werror=profile-instr-out-of-date", "-Werror=backend-plugin"])
+    else:
+        if env["optimize"] == "pgo_generate":
+            env.Append(CCFLAGS=["-fprofile-generate=" + pgo_dir, "-fprofile-update=atomic"])
+            env.Append(LINKFLAGS=["-fprofile-generate=" + pgo_dir])
+        else:
+            env.Append(CCFLAGS=["-fprofile-use=" + pgo_dir, "-fprofile-partial-training"])
+            # Objects the training run never linked have no profile, which must not pass silently.
+            env.Append(CCFLAGS=["-Werror=coverage-mismatch", "-Werror=missing-profile"])
+
+
 def generate(env):
     opt_level = "speed"
 
@@ -41,7 +166,7 @@ def generate(env):
             env.Append(CCFLAGS=["/Zi", "/FS"])
             env.Append(LINKFLAGS=["/DEBUG:FULL"])
 
-        if env["optimize"] == "speed" or env["optimize"] == "speed_trace":
+        if env["optimize"] in ["speed", "speed_trace", "pgo_generate", "pgo_use"]:
             env.Append(CCFLAGS=["/O2"])
             env.Append(LINKFLAGS=["/OPT:REF"])
         elif env["optimize"] == "size":
@@ -58,7 +183,7 @@ def generate(env):
             else:
                 env.Append(CCFLAGS=["-g2"])
 
-        if env["optimize"] == "speed":
+        if env["optimize"] in ["speed", "pgo_generate", "pgo_use"]:
             env.Append(CCFLAGS=["-O3"])
         # `-O2` is friendlier to debuggers than `-O3`, leading to better crash backtraces.
         elif env["optimize"] == "speed_trace":
@@ -69,3 +194,9 @@ def generate(env):
             env.Append(CCFLAGS=["-Og"])
         elif env["optimize"] == "none":
             env.Append(CCFLAGS=["-O0"])
+
+    if env["optimize"] in ["pgo_generate", "pgo_use"]:
+        setup_pgo(env)
+
+    if env["lto"] != "none":
+        setup_lto(env)
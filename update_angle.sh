@@ -35,7 +35,54 @@ run_custom_steps_at_source() {
     }
 
     run_step 'src/commit_id.py gen $OUTDIR/angle_commit.h'
-    run_step 'src/program_serialize_data_version.py $OUTDIR/ANGLEShaderProgramVersion.h ../file_list'
+}
+
+# Program binaries are only invalidated by code that can change them, so instead of the whole
+# file_list, each platform hashes the translator, the frontend program code and its own renderers.
+# The header next to every selected source is hashed as well. This runs after godot-patches are
+# applied, so the hashed sources are the patched ones, and the patches are hashed too, as any of
+# them can change the translator or the program code.
+PROGRAM_VERSION_COMMON="^\./src/compiler/"
+PROGRAM_VERSION_COMMON+="|^\./src/common/(CompiledShaderState|PackedEnums|PackedGLEnums_autogen|angleutils|uniform_type_info_autogen|utilities)\.cpp$"
+PROGRAM_VERSION_COMMON+="|^\./src/libANGLE/(BlobCache|Caps|Compiler|MemoryProgramCache|MemoryShaderCache|Program|ProgramExecutable|ProgramLinkedResources|ProgramPipeline|Shader|Uniform|VaryingPacking|angletypes)\.cpp$"
+PROGRAM_VERSION_COMMON+="|^\./src/libANGLE/renderer/(ProgramImpl|ProgramPipelineImpl|ShaderImpl|renderer_utils)\.cpp$"
+PROGRAM_VERSION_COMMON+="|^\./src/libANGLE/renderer/null/"
+PROGRAM_VERSION_BACKENDS="^\./src/compiler/translator/(tree_ops/)?(hlsl|msl)/"
+PROGRAM_VERSION_HEADERS="./include/GLSLANG/ShaderLang.h ./include/GLSLANG/ShaderVars.h ./src/common/BinaryStream.h"
+
+run_program_version_step() {
+    local P_PLATFORM=$1
+    local P_PATTERN=$2
+
+    echo "Program version: $P_PLATFORM"
+
+    local OUTDIR=$GODOT_DIR/godot-angle/$P_PLATFORM
+    mkdir -p $OUTDIR
+    check_error
+    pushd ./angle > /dev/null
+    check_error
+    {
+        grep -E "$PROGRAM_VERSION_COMMON" ../file_list | grep -vE "$PROGRAM_VERSION_BACKENDS"
+        grep -E "$P_PATTERN" ../file_list
+    } | sort -u | while read -r SOURCE; do
+        echo "$SOURCE"
+        if [ -f "${SOURCE%.*}.h" ]; then echo "${SOURCE%.*}.h"; fi
+    done > $OUTDIR/program_version_files
+    for HEADER in $PROGRAM_VERSION_HEADERS; do echo "$HEADER"; done >> $OUTDIR/program_version_files
+    if [ -d ../godot-patches ]; then
+        find ../godot-patches -name '*.diff' | sort >> $OUTDIR/program_version_files
+    fi
+    python3 src/program_serialize_data_version.py $OUTDIR/ANGLEShaderProgramVersion.h $OUTDIR/program_version_files
+    check_error
+    popd > /dev/null
+    check_error
+}
+
+run_program_version_steps() {
+    run_program_version_step windows "^\./src/libANGLE/renderer/d3d/|^\./src/compiler/translator/(tree_ops/)?hlsl/"
+    run_program_version_step macos "^\./src/libANGLE/renderer/(metal/|gl/[^/]*$|gl/cgl/)|^\./src/compiler/translator/(tree_ops/)?msl/"
+    run_program_version_step ios "^\./src/libANGLE/renderer/(metal/|gl/[^/]*$|gl/eagl/)|^\./src/compiler/translator/(tree_ops/)?msl/"
+    run_program_version_step linux "^\./src/libANGLE/renderer/(gl/[^/]*$|gl/egl/)"
 }
 
 GODOT_DIR=$(pwd)
@@ -49,5 +96,13 @@ run_custom_steps_at_source
 
 if [ -d ./godot-patches ]; then
     echo "Applying patches"
-    find ./godot-patches -name '*.diff' -exec git apply {} \;
+    # `find -exec` exits with 0 whatever git apply returns, so a patch which does not apply would be
+    # skipped silently. Every patch has to apply.
+    for PATCH in $(find ./godot-patches -name '*.diff' | sort); do
+        echo "Patch: $PATCH"
+        git apply "$PATCH"
+        check_error
+    done
 fi
+
+run_program_version_steps
@@ -0,0 +1,267 @@
+//
+// Software ASTC decode throughput through angle::AstcDecompressor, the path ANGLE takes when a
+// backend has to emulate ASTC textures. Every 2D block footprint is decoded with a single
+// threaded pool and with a pool sized to the machine, and reported in MB/s of RGBA8 output and of
+// compressed input. Compare builds with different `astcenc_isa` values.
+//
+// The blocks are generated with a fixed seed unless `--image` names an .astc file, in which case
+// only its footprint is measured. Generated blocks have a legal header, cycling through one and two
+// partition LDR endpoint modes and three weight quantizations of a 4x4 weight grid, with random
+// endpoints, weights and partition patterns, so that every block decodes through the regular path.
+// A case fails if more than 1% of its texels decode to the error color.
+//
+// Usage: bench_astc [--size=N] [--rounds=N] [--image=file.astc]
+//
+
+#include "workload_utils.h"
+
+#include "common/WorkerThread.h"
+#include "image_util/AstcDecompressor.h"
+#include "platform/PlatformMethods.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+struct AstcImage
+{
+    uint32_t blockWidth;
+    uint32_t blockHeight;
+    uint32_t width;
+    uint32_t height;
+    std::vector<uint8_t> blocks;
+};
+
+constexpr uint32_t kAstcMagic       = 0x5CA1AB13;
+constexpr size_t kAstcHeaderSize    = 16;
+constexpr size_t kAstcBlockSize     = 16;
+constexpr uint32_t kFootprints[][2] = {{4, 4},  {5, 4},  {5, 5},   {6, 5},   {6, 6},
+                                       {8, 5},  {8, 6},  {8, 8},   {10, 5},  {10, 6},
+                                       {10, 8}, {10, 10}, {12, 10}, {12, 12}};
+
+size_t GetBlockCount(uint32_t width, uint32_t height, uint32_t blockWidth, uint32_t blockHeight)
+{
+    return static_cast<size_t>((width + blockWidth - 1) / blockWidth) *
+           ((height + blockHeight - 1) / blockHeight);
+}
+
+void SetBits(uint8_t *block, uint32_t offset, uint32_t count, uint32_t value)
+{
+    for (uint32_t bit = 0; bit < count; ++bit)
+    {
+        uint8_t &byte = block[(offset + bit) / 8];
+        const uint8_t mask = static_cast<uint8_t>(1 << ((offset + bit) % 8));
+        byte = ((value >> bit) & 1) != 0 ? byte | mask : byte & ~mask;
+    }
+}
+
+// The header of a block, every other bit of which is random. Each block mode selects a 4x4 weight
+// grid, which fits every footprint, and leaves enough bits for the endpoints to be stored at
+// QUANT_6 or better, below which a block is illegal.
+struct AstcBlockHeader
+{
+    uint32_t blockMode;
+    uint32_t partitionCount;
+    uint32_t endpointMode;
+};
+
+constexpr AstcBlockHeader kBlockHeaders[] = {
+    {66, 1, 12},   // QUANT_4 weights, RGBA direct
+    {83, 1, 8},    // QUANT_8 weights, RGB direct
+    {578, 1, 0},   // QUANT_16 weights, luminance direct
+    {66, 2, 8},    // QUANT_4 weights, RGB direct
+    {83, 2, 4},    // QUANT_8 weights, luminance-alpha direct
+};
+
+AstcImage MakeImage(uint32_t size, uint32_t blockWidth, uint32_t blockHeight)
+{
+    AstcImage image = {blockWidth, blockHeight, size, size, {}};
+    image.blocks.resize(GetBlockCount(size, size, blockWidth, blockHeight) * kAstcBlockSize);
+
+    std::mt19937 random(blockWidth * 16 + blockHeight);
+    for (uint8_t &byte : image.blocks)
+    {
+        byte = static_cast<uint8_t>(random());
+    }
+    for (size_t offset = 0; offset < image.blocks.size(); offset += kAstcBlockSize)
+    {
+        uint8_t *block                = &image.blocks[offset];
+        const AstcBlockHeader &header = kBlockHeaders[random() % std::size(kBlockHeaders)];
+        SetBits(block, 0, 11, header.blockMode);
+        SetBits(block, 11, 2, header.partitionCount - 1);
+        if (header.partitionCount == 1)
+        {
+            SetBits(block, 13, 4, header.endpointMode);
+        }
+        else
+        {
+            // Bits 13 to 22 are the partition pattern. A zero selector gives every partition the
+            // endpoint mode that follows it.
+            SetBits(block, 23, 2, 0);
+            SetBits(block, 25, 4, header.endpointMode);
+        }
+    }
+    return image;
+}
+
+uint32_t ReadUint24(const uint8_t *bytes)
+{
+    return bytes[0] | (bytes[1] << 8) | (bytes[2] << 16);
+}
+
+// Reads the file format written by astcenc, 2D images only.
+bool LoadAstcImage(const std::string &path, AstcImage *image)
+{
+    std::ifstream file(path, std::ios::binary);
+    std::vector<uint8_t> contents((std::istreambuf_iterator<char>(file)),
+                                  std::istreambuf_iterator<char>());
+    if (contents.size() < kAstcHeaderSize)
+    {
+        fprintf(stderr, "Could not read %s.\n", path.c_str());
+        return false;
+    }
+
+    const uint32_t magic = contents[0] | (contents[1] << 8) | (contents[2] << 16) |
+                           (static_cast<uint32_t>(contents[3]) << 24);
+    image->blockWidth    = contents[4];
+    image->blockHeight   = contents[5];
+    image->width         = ReadUint24(&contents[7]);
+    image->height        = ReadUint24(&contents[10]);
+    const uint32_t depth = ReadUint24(&contents[13]);
+    if (magic != kAstcMagic || contents[6] != 1 || depth != 1)
+    {
+        fprintf(stderr, "%s is not a 2D .astc file.\n", path.c_str());
+        return false;
+    }
+
+    const size_t blockBytes =
+        GetBlockCount(image->width, image->height, image->blockWidth, image->blockHeight) *
+        kAstcBlockSize;
+    if (contents.size() < kAstcHeaderSize + blockBytes)
+    {
+        fprintf(stderr, "%s is truncated.\n", path.c_str());
+        return false;
+    }
+    image->blocks.assign(contents.begin() + kAstcHeaderSize,
+                         contents.begin() + kAstcHeaderSize + blockBytes);
+    return true;
+}
+
+// Opaque magenta, which astcenc writes for every texel of an illegal LDR block.
+size_t CountErrorTexels(const std::vector<uint8_t> &rgba)
+{
+    size_t count = 0;
+    for (size_t offset = 0; offset < rgba.size(); offset += 4)
+    {
+        if (rgba[offset] == 0xFF && rgba[offset + 1] == 0x00 && rgba[offset + 2] == 0xFF &&
+            rgba[offset + 3] == 0xFF)
+        {
+            ++count;
+        }
+    }
+    return count;
+}
+
+bool RunCase(const char *poolName,
+             const AstcImage &image,
+             int rounds,
+             const std::shared_ptr<angle::WorkerThreadPool> &singleThreadPool,
+             const std::shared_ptr<angle::WorkerThreadPool> &multiThreadPool)
+{
+    angle::AstcDecompressor &decompressor = angle::AstcDecompressor::get();
+    std::vector<uint8_t> output(static_cast<size_t>(image.width) * image.height * 4);
+
+    // The first call also sets up the astcenc context for this footprint.
+    double elapsedMs = 0.0;
+    for (int round = -1; round < rounds; ++round)
+    {
+        workloads::Timer timer;
+        int32_t status = decompressor.decompress(
+            singleThreadPool, multiThreadPool, image.width, image.height, image.blockWidth,
+            image.blockHeight, image.blocks.data(), image.blocks.size(), output.data());
+        if (status != 0)
+        {
+            fprintf(stderr, "Decoding %ux%u failed: %s\n", image.blockWidth, image.blockHeight,
+                    decompressor.getStatusString(status));
+            return false;
+        }
+        if (round >= 0)
+        {
+            elapsedMs += timer.elapsedMs();
+        }
+    }
+
+    const size_t errorTexels = CountErrorTexels(output);
+    if (errorTexels > output.size() / 4 / 100)
+    {
+        fprintf(stderr, "Decoding %ux%u gave %zu error color texels, the blocks are not legal.\n",
+                image.blockWidth, image.blockHeight, errorTexels);
+        return false;
+    }
+
+    const double seconds  = elapsedMs / 1000.0;
+    const double outputMB = static_cast<double>(output.size()) * rounds / (1024.0 * 1024.0);
+    const double inputMB  = static_cast<double>(image.blocks.size()) * rounds / (1024.0 * 1024.0);
+    printf("%2ux%-2u %-8s %10.1f MB/s out %10.1f MB/s in\n", image.blockWidth,
+           image.blockHeight, poolName, outputMB / seconds, inputMB / seconds);
+    return true;
+}
+
+}  // anonymous namespace
+
+int main(int argc, char **argv)
+{
+    const uint32_t size = atoi(workloads::GetArgument(argc, argv, "--size", "2048").c_str());
+    const int rounds    = atoi(workloads::GetArgument(argc, argv, "--rounds", "10").c_str());
+    const std::string imagePath = workloads::GetArgument(argc, argv, "--image", "");
+
+    angle::AstcDecompressor &decompressor = angle::AstcDecompressor::get();
+    if (!decompressor.available())
+    {
+        fprintf(stderr, "ANGLE was built without the astcenc decompressor.\n");
+        return EXIT_FAILURE;
+    }
+
+    std::vector<AstcImage> images;
+    if (!imagePath.empty())
+    {
+        AstcImage image;
+        if (!LoadAstcImage(imagePath, &image))
+        {
+            return EXIT_FAILURE;
+        }
+        images.push_back(std::move(image));
+    }
+    else
+    {
+        for (const uint32_t *footprint : kFootprints)
+        {
+            images.push_back(MakeImage(size, footprint[0], footprint[1]));
+        }
+    }
+
+    // A thread count of zero sizes the pool to the number of cores.
+    std::shared_ptr<angle::WorkerThreadPool> singleThreadPool =
+        angle::WorkerThreadPool::Create(1, ANGLEPlatformCurrent());
+    std::shared_ptr<angle::WorkerThreadPool> multiThreadPool =
+        angle::WorkerThreadPool::Create(0, ANGLEPlatformCurrent());
+
+    printf("%ux%u texels, %d rounds per case\n", images[0].width, images[0].height, rounds);
+    for (const AstcImage &image : images)
+    {
+        if (!RunCase("1 thread", image, rounds, singleThreadPool, singleThreadPool) ||
+            !RunCase("pool", image, rounds, singleThreadPool, multiThreadPool))
+        {
+            return EXIT_FAILURE;
+        }
+    }
+    return EXIT_SUCCESS;
+}
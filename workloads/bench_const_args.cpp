@@ -0,0 +1,207 @@
+//
+// Propagation of constant arguments into the functions they are passed to, for every output built
+// into libANGLE_translator. A material shader is generated the way Godot's variant-heavy materials
+// are written: `--functions` generic helpers taking a blend mode and a sample count, each called
+// `--calls` times with literal arguments, so the mode is chosen by a branch chain and the loop
+// bound is a parameter. PropagateConstantArguments gives every distinct argument set its own copy
+// of the helper, in which FoldExpressions and PruneDeadBranches fold the chain away. Its twin is
+// generated with those copies written out by hand, which is what the output should be. Both are
+// translated `--rounds` times, printing the output size and translation time of each; "left" is
+// what the translator did not specialize. Build with `translator_all_backends=yes` to include the
+// HLSL output D3DCompile would get; compiling it needs D3DCompile, so that time is not measured.
+// When built with `propagate_constant_arguments=yes`, the run fails if an output still defines a
+// generic helper, as long as the copies needed fit in what the pass makes per shader.
+//
+// Usage: bench_const_args [--functions=N] [--calls=N] [--rounds=N]
+//
+
+#include "workload_utils.h"
+
+#include <GLSLANG/ShaderLang.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+namespace
+{
+
+constexpr int kBlendModeCount = 4;
+
+#if defined(ANGLE_GODOT_PROPAGATE_CONSTANT_ARGUMENTS)
+// The most copies PropagateConstantArguments makes in one shader.
+constexpr int kMaxCopiesPerShader = 64;
+
+// Returns the index of a generic helper the output still defines, or -1.
+int FindGenericHelper(const std::string &output, int functionCount)
+{
+    for (int function = 0; function < functionCount; ++function)
+    {
+        if (output.find("layer" + std::to_string(function) + "(") != std::string::npos)
+        {
+            return function;
+        }
+    }
+    return -1;
+}
+#endif
+
+// The blend each mode selects, as an expression of `color` and `layer`.
+constexpr const char *kBlendModes[kBlendModeCount] = {
+    "color + layer",
+    "color * layer",
+    "mix(color, layer, 0.5)",
+    "max(color, layer)",
+};
+
+std::string MakeGenericHelper(const std::string &name, int index)
+{
+    std::string helper = "vec3 " + name + "(vec3 color, int mode, int samples)\n{\n" +
+                         "    vec3 layer = vec3(0.0);\n" +
+                         "    for (int i = 0; i < samples; ++i)\n    {\n" +
+                         "        layer += texture(textures[" + std::to_string(index % 4) +
+                         "], uv * params[i].xy).rgb;\n    }\n" +
+                         "    layer /= float(samples);\n";
+    for (int mode = 0; mode < kBlendModeCount; ++mode)
+    {
+        helper += std::string(mode == 0 ? "    if" : "    else if") + " (mode == " +
+                  std::to_string(mode) + ")\n    {\n        color = " + kBlendModes[mode] +
+                  ";\n    }\n";
+    }
+    return helper + "    return color;\n}\n";
+}
+
+std::string MakeSpecializedHelper(const std::string &name, int index, int mode, int samples)
+{
+    return "vec3 " + name + "(vec3 color)\n{\n    vec3 layer = vec3(0.0);\n" +
+           "    for (int i = 0; i < " + std::to_string(samples) + "; ++i)\n    {\n" +
+           "        layer += texture(textures[" + std::to_string(index % 4) +
+           "], uv * params[i].xy).rgb;\n    }\n    layer /= " + std::to_string(samples) +
+           ".0;\n    return " + kBlendModes[mode] + ";\n}\n";
+}
+
+// With `specialized`, every distinct argument set gets its own helper, called without arguments.
+std::string MakeMaterialShader(int functionCount, int callCount, bool specialized)
+{
+    std::string source =
+        "#version 300 es\nprecision highp float;\nin vec2 uv;\n"
+        "uniform sampler2D textures[4];\nuniform vec4 params[8];\nout vec4 frag_color;\n";
+    std::string body = "void main()\n{\n    vec3 color = params[0].rgb;\n";
+    for (int function = 0; function < functionCount; ++function)
+    {
+        const std::string name = "layer" + std::to_string(function);
+        if (!specialized)
+        {
+            source += MakeGenericHelper(name, function);
+        }
+        for (int call = 0; call < callCount; ++call)
+        {
+            const int mode    = (function + call) % kBlendModeCount;
+            const int samples = 1 + call % kBlendModeCount;
+            if (specialized)
+            {
+                // The argument sets repeat every kBlendModeCount calls, and so do the
+                // specializations.
+                const std::string specializedName =
+                    name + "_" + std::to_string(mode) + "_" + std::to_string(samples);
+                if (call < kBlendModeCount)
+                {
+                    source += MakeSpecializedHelper(specializedName, function, mode, samples);
+                }
+                body += "    color = " + specializedName + "(color);\n";
+            }
+            else
+            {
+                body += "    color = " + name + "(color, " + std::to_string(mode) + ", " +
+                        std::to_string(samples) + ");\n";
+            }
+        }
+    }
+    return source + body + "    frag_color = vec4(color, 1.0);\n}\n";
+}
+
+// Returns the translation time in ms, or a negative value if the shader failed to translate.
+double Translate(ShHandle compiler, const std::string &source, int rounds, std::string *output)
+{
+    ShCompileOptions options;
+    options.objectCode = true;
+    options.variables  = true;
+
+    const char *strings[] = {source.c_str()};
+    workloads::Timer timer;
+    for (int round = 0; round < rounds; ++round)
+    {
+        if (!sh::Compile(compiler, strings, 1, options))
+        {
+            fprintf(stderr, "Could not translate:\n%s\n", sh::GetInfoLog(compiler).c_str());
+            return -1.0;
+        }
+    }
+    *output = sh::GetObjectCode(compiler);
+    return timer.elapsedMs() / rounds;
+}
+
+}  // anonymous namespace
+
+int main(int argc, char **argv)
+{
+    const int functionCount =
+        atoi(workloads::GetArgument(argc, argv, "--functions", "16").c_str());
+    const int callCount = atoi(workloads::GetArgument(argc, argv, "--calls", "4").c_str());
+    const int rounds    = atoi(workloads::GetArgument(argc, argv, "--rounds", "10").c_str());
+    if (functionCount < 1 || callCount < 1 || rounds < 1)
+    {
+        fprintf(stderr, "--functions, --calls and --rounds must be at least 1.\n");
+        return EXIT_FAILURE;
+    }
+
+    sh::Initialize();
+    ShBuiltInResources resources;
+    workloads::InitTranslatorResources(&resources);
+
+    const std::string source            = MakeMaterialShader(functionCount, callCount, false);
+    const std::string specializedSource = MakeMaterialShader(functionCount, callCount, true);
+    printf("%d helpers called %d times each, %d rounds, per compile:\n", functionCount, callCount,
+           rounds);
+    printf("%-20s %12s %16s %12s %12s %16s\n", "Output", "output KB", "specialized KB", "left KB",
+           "ms", "specialized ms");
+
+    bool success = true;
+    for (const workloads::TranslatorOutput &output : workloads::kTranslatorOutputs)
+    {
+        ShHandle compiler = sh::ConstructCompiler(GL_FRAGMENT_SHADER, SH_GLES3_SPEC, output.output,
+                                                  &resources);
+        std::string translated;
+        std::string specializedTranslated;
+        const double ms = Translate(compiler, source, rounds, &translated);
+        const double specializedMs =
+            Translate(compiler, specializedSource, rounds, &specializedTranslated);
+        sh::Destruct(compiler);
+        if (ms < 0.0 || specializedMs < 0.0)
+        {
+            success = false;
+            continue;
+        }
+
+        printf("%-20s %12.1f %16.1f %12.1f %12.3f %16.3f\n", output.name,
+               translated.size() / 1024.0, specializedTranslated.size() / 1024.0,
+               (static_cast<double>(translated.size()) - specializedTranslated.size()) / 1024.0,
+               ms, specializedMs);
+
+#if defined(ANGLE_GODOT_PROPAGATE_CONSTANT_ARGUMENTS)
+        // Every helper gets one copy per distinct argument set.
+        const int generic = FindGenericHelper(translated, functionCount);
+        if (functionCount * std::min(callCount, kBlendModeCount) <= kMaxCopiesPerShader &&
+            generic >= 0)
+        {
+            fprintf(stderr, "%s output still defines the generic layer%d.\n", output.name,
+                    generic);
+            success = false;
+        }
+#endif
+    }
+
+    sh::Finalize();
+    return success ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,164 @@
+//
+// Dead function and branch elimination in the translator, for every output built into
+// libANGLE_translator. A shader is generated the way Godot's material shaders look with most
+// features off: `--functions` helper functions, of which only `--used` are reached, the rest
+// called from `if` blocks on `const bool` feature flags which are false. Half of those conditions
+// are the flag alone, which the parser prunes. The other half are `QUALITY > 1 ? FLAG : false`,
+// which only FoldExpressions makes constant, for PruneDeadBranches to prune. Its twin is generated
+// without the unused functions and their blocks, which is what the output should be. Both are
+// translated `--rounds` times, printing the output size and translation time of each. "left" is
+// the dead code the translator still emitted, which the driver compilers downstream (D3DCompile,
+// the Metal compiler, the GL driver) have to compile. When built with `prune_dead_branches=yes`,
+// the run fails if any output still defines one of the unused functions.
+//
+// Usage: bench_dead_code [--functions=N] [--used=N] [--rounds=N]
+//
+
+#include "workload_utils.h"
+
+#include <GLSLANG/ShaderLang.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+namespace
+{
+
+// With `pruned`, leaves out the functions past `usedCount` and the blocks calling them. The flags
+// are declared either way.
+std::string MakeFeatureShader(int functionCount, int usedCount, bool pruned)
+{
+    std::string source =
+        "#version 300 es\nprecision highp float;\nin vec2 uv;\nin vec3 normal;\n"
+        "uniform sampler2D albedo_texture;\nuniform vec4 params[8];\nout vec4 frag_color;\n"
+        "const int QUALITY = 1;\n";
+    for (int i = 0; i < functionCount; ++i)
+    {
+        const bool used         = i < usedCount;
+        const std::string index = std::to_string(i);
+        source += "const bool FEATURE_" + index + " = " + (used ? "true" : "false") + ";\n";
+        if (pruned && !used)
+        {
+            continue;
+        }
+        source += "vec3 feature" + index + "(vec3 color)\n{\n    vec3 n = normalize(normal);\n" +
+                  "    for (int i = 0; i < 4; ++i)\n    {\n" +
+                  "        color += texture(albedo_texture, uv * params[" +
+                  std::to_string(i % 8) + "].xy + float(i)).rgb * max(dot(n, params[i].xyz), " +
+                  "0.0);\n    }\n    return color * " + index + ".5;\n}\n";
+    }
+    source += "void main()\n{\n    vec3 color = params[0].rgb;\n";
+    for (int i = 0; i < functionCount; ++i)
+    {
+        if (pruned && i >= usedCount)
+        {
+            continue;
+        }
+        const std::string index = std::to_string(i);
+        const std::string flag  = "FEATURE_" + index;
+        const std::string condition =
+            i >= usedCount && i % 2 == 1 ? "QUALITY > 1 ? " + flag + " : false" : flag;
+        source += "    if (" + condition + ")\n    {\n        color = feature" + index +
+                  "(color);\n    }\n";
+    }
+    return source + "    frag_color = vec4(color, 1.0);\n}\n";
+}
+
+#if defined(ANGLE_GODOT_PRUNE_DEAD_BRANCHES)
+// Returns the index of an unused feature function the output still defines, or -1. Every output
+// keeps the source names of the functions, behind a prefix which depends on the backend.
+int FindUnusedFunction(const std::string &output, int functionCount, int usedCount)
+{
+    for (int i = usedCount; i < functionCount; ++i)
+    {
+        if (output.find("feature" + std::to_string(i) + "(") != std::string::npos)
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+#endif
+
+// Returns the translation time in ms, or a negative value if the shader failed to translate.
+double Translate(ShHandle compiler, const std::string &source, int rounds, std::string *output)
+{
+    ShCompileOptions options;
+    options.objectCode = true;
+    options.variables  = true;
+
+    const char *strings[] = {source.c_str()};
+    workloads::Timer timer;
+    for (int round = 0; round < rounds; ++round)
+    {
+        if (!sh::Compile(compiler, strings, 1, options))
+        {
+            fprintf(stderr, "Could not translate:\n%s\n", sh::GetInfoLog(compiler).c_str());
+            return -1.0;
+        }
+    }
+    *output = sh::GetObjectCode(compiler);
+    return timer.elapsedMs() / rounds;
+}
+
+}  // anonymous namespace
+
+int main(int argc, char **argv)
+{
+    const int functionCount =
+        atoi(workloads::GetArgument(argc, argv, "--functions", "128").c_str());
+    const int usedCount = atoi(workloads::GetArgument(argc, argv, "--used", "8").c_str());
+    const int rounds    = atoi(workloads::GetArgument(argc, argv, "--rounds", "10").c_str());
+    if (functionCount < 1 || usedCount < 0 || usedCount > functionCount || rounds < 1)
+    {
+        fprintf(stderr, "Need --functions >= 1, 0 <= --used <= --functions, --rounds >= 1.\n");
+        return EXIT_FAILURE;
+    }
+
+    sh::Initialize();
+    ShBuiltInResources resources;
+    workloads::InitTranslatorResources(&resources);
+
+    const std::string source       = MakeFeatureShader(functionCount, usedCount, false);
+    const std::string prunedSource = MakeFeatureShader(functionCount, usedCount, true);
+    printf("%d of %d feature functions used, %d rounds, per compile:\n", usedCount, functionCount,
+           rounds);
+    printf("%-20s %12s %12s %12s %12s %12s\n", "Output", "output KB", "pruned KB", "left KB",
+           "ms", "pruned ms");
+
+    bool success = true;
+    for (const workloads::TranslatorOutput &output : workloads::kTranslatorOutputs)
+    {
+        ShHandle compiler = sh::ConstructCompiler(GL_FRAGMENT_SHADER, SH_GLES3_SPEC, output.output,
+                                                  &resources);
+        std::string translated;
+        std::string prunedTranslated;
+        const double ms       = Translate(compiler, source, rounds, &translated);
+        const double prunedMs = Translate(compiler, prunedSource, rounds, &prunedTranslated);
+        sh::Destruct(compiler);
+        if (ms < 0.0 || prunedMs < 0.0)
+        {
+            success = false;
+            continue;
+        }
+
+        printf("%-20s %12.1f %12.1f %12.1f %12.3f %12.3f\n", output.name,
+               translated.size() / 1024.0, prunedTranslated.size() / 1024.0,
+               (static_cast<double>(translated.size()) - prunedTranslated.size()) / 1024.0, ms,
+               prunedMs);
+
+#if defined(ANGLE_GODOT_PRUNE_DEAD_BRANCHES)
+        const int unused = FindUnusedFunction(translated, functionCount, usedCount);
+        if (unused >= 0)
+        {
+            fprintf(stderr, "%s output still defines the unused feature%d.\n", output.name,
+                    unused);
+            success = false;
+        }
+#endif
+    }
+
+    sh::Finalize();
+    return success ? EXIT_SUCCESS : EXIT_FAILURE;
+}
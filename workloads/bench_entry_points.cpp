@@ -0,0 +1,133 @@
+//
+// Measures the CPU cost of individual GL entry points, from the exported gl* function down
+// through validation and gl::Context. Use the null renderer (`renderer_null=yes`) so backend
+// work does not dominate, and compare builds with `lto=none` and `lto=thin` / `lto=full` to see
+// what cross-archive inlining saves per call.
+//
+// Usage: bench_entry_points [--backend=null|gl_null|native] [--iterations=N]
+//
+
+#include "workload_utils.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+namespace
+{
+
+constexpr char kVertexShader[] = R"(#version 300 es
+layout(location = 0) in vec4 position;
+void main() { gl_Position = position; })";
+
+constexpr char kFragmentShader[] = R"(#version 300 es
+precision mediump float;
+uniform vec4 color;
+out vec4 fragColor;
+void main() { fragColor = color; })";
+
+// A template rather than std::function, so the harness does not add an indirect call of its own.
+template <typename Body>
+void RunCase(const char *name, int iterations, Body &&body)
+{
+    // Warm up caches and lazily initialized state first.
+    for (int i = 0; i < iterations / 10; ++i)
+    {
+        body(i);
+    }
+    glFinish();
+
+    workloads::Timer timer;
+    for (int i = 0; i < iterations; ++i)
+    {
+        body(i);
+    }
+    glFinish();
+    double elapsedMs = timer.elapsedMs();
+    printf("%-32s %10.2f ns/call\n", name, elapsedMs * 1e6 / iterations);
+}
+
+}  // anonymous namespace
+
+int main(int argc, char **argv)
+{
+    const std::string backend = workloads::GetArgument(argc, argv, "--backend", "null");
+    const int iterations =
+        atoi(workloads::GetArgument(argc, argv, "--iterations", "1000000").c_str());
+
+    workloads::EGLWindow window;
+    if (!workloads::InitializeEGLWindow(backend, &window))
+    {
+        workloads::DestroyEGLWindow(&window);
+        return EXIT_FAILURE;
+    }
+
+    workloads::ShaderSource vertex   = {"bench.vert", GL_VERTEX_SHADER, kVertexShader};
+    workloads::ShaderSource fragment = {"bench.frag", GL_FRAGMENT_SHADER, kFragmentShader};
+    GLuint program = workloads::LinkProgram({"bench", &vertex, &fragment});
+    if (program == 0)
+    {
+        workloads::DestroyEGLWindow(&window);
+        return EXIT_FAILURE;
+    }
+    glUseProgram(program);
+    GLint colorLocation = glGetUniformLocation(program, "color");
+
+    GLuint buffers[3] = {};
+    glGenBuffers(3, buffers);
+    const float vertices[] = {-1.0f, -1.0f, 0.0f, 1.0f, 1.0f, -1.0f, 0.0f, 1.0f,
+                              0.0f,  1.0f,  0.0f, 1.0f};
+    glBindBuffer(GL_ARRAY_BUFFER, buffers[0]);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, buffers[1]);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+    const GLushort indices[] = {0, 1, 2};
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffers[2]);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, buffers[0]);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 0, nullptr);
+
+    GLuint textures[2] = {};
+    glGenTextures(2, textures);
+
+    printf("Backend: %s, %d iterations per case\n", backend.c_str(), iterations);
+    RunCase("glGetError", iterations, [](int) { glGetError(); });
+    RunCase("glIsEnabled", iterations, [](int) { glIsEnabled(GL_BLEND); });
+    RunCase("glEnable/glDisable", iterations, [](int i) {
+        if (i & 1)
+        {
+            glEnable(GL_BLEND);
+        }
+        else
+        {
+            glDisable(GL_BLEND);
+        }
+    });
+    RunCase("glUniform4f", iterations, [colorLocation](int i) {
+        glUniform4f(colorLocation, static_cast<float>(i & 255) / 255.0f, 0.0f, 0.0f, 1.0f);
+    });
+    RunCase("glBindBuffer", iterations,
+            [&buffers](int i) { glBindBuffer(GL_ARRAY_BUFFER, buffers[i & 1]); });
+    RunCase("glBindTexture", iterations,
+            [&textures](int i) { glBindTexture(GL_TEXTURE_2D, textures[i & 1]); });
+    RunCase("glDrawArrays", iterations, [](int) { glDrawArrays(GL_TRIANGLES, 0, 3); });
+    RunCase("glDrawElements", iterations,
+            [](int) { glDrawElements(GL_TRIANGLES, 3, GL_UNSIGNED_SHORT, nullptr); });
+    RunCase("glUniform4f + glDrawArrays", iterations, [colorLocation](int i) {
+        glUniform4f(colorLocation, static_cast<float>(i & 255) / 255.0f, 0.0f, 0.0f, 1.0f);
+        glDrawArrays(GL_TRIANGLES, 0, 3);
+    });
+
+    GLenum error = glGetError();
+    if (error != GL_NO_ERROR)
+    {
+        fprintf(stderr, "GL error 0x%04X during the benchmark.\n", error);
+    }
+
+    glDeleteTextures(2, textures);
+    glDeleteBuffers(3, buffers);
+    glDeleteProgram(program);
+    workloads::DestroyEGLWindow(&window);
+    return error == GL_NO_ERROR ? EXIT_SUCCESS : EXIT_FAILURE;
+}
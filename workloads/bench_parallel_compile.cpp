@@ -0,0 +1,220 @@
+//
+// Scaling of godot_angle::ProgramBatch with the number of cores. Every corpus program is compiled
+// in `--variants` versions which differ by a define, like Godot's shader variants, so that ANGLE's
+// shader and program caches never hit. The batch is timed with the process restricted to 1, 2, 4,
+// ... up to `--max-cores` of the cores it may run on, as `taskset -a` would, so ANGLE's worker
+// threads share that many cores. `--max-pending` passes a limit of programs in flight to the
+// batch, zero for none. Restricting the cores is only supported on Linux and Windows; elsewhere
+// a single round runs on every core.
+//
+// Usage: bench_parallel_compile [--corpus=workloads/shaders] [--backend=null|gl_null|native]
+//                               [--variants=N] [--max-cores=N] [--max-pending=N]
+//
+
+#include "workload_utils.h"
+
+#include "ProgramBatch.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#if defined(_WIN32)
+#    ifndef WIN32_LEAN_AND_MEAN
+#        define WIN32_LEAN_AND_MEAN
+#    endif
+#    ifndef NOMINMAX
+#        define NOMINMAX
+#    endif
+#    include <windows.h>
+#elif defined(__linux__)
+#    include <dirent.h>
+#    include <sched.h>
+#endif
+
+namespace
+{
+
+// Adds a define after the #version line, which has to stay first.
+std::string MakeVariant(const std::string &source, int round, int variant)
+{
+    size_t versionEnd = source.find('\n') + 1;
+    return source.substr(0, versionEnd) + "#define VARIANT_" + std::to_string(round) + "_" +
+           std::to_string(variant) + "\n" + source.substr(versionEnd);
+}
+
+#if defined(_WIN32)
+using CoreMask = DWORD_PTR;
+#elif defined(__linux__)
+using CoreMask = cpu_set_t;
+#else
+using CoreMask = int;
+#endif
+
+// The cores the process may run on at startup, and how many there are; zero if the platform cannot
+// restrict them.
+int GetAvailableCores(CoreMask *available)
+{
+#if defined(_WIN32)
+    DWORD_PTR systemMask = 0;
+    if (!GetProcessAffinityMask(GetCurrentProcess(), available, &systemMask))
+    {
+        return 0;
+    }
+    int count = 0;
+    for (DWORD_PTR mask = *available; mask != 0; mask &= mask - 1)
+    {
+        ++count;
+    }
+    return count;
+#elif defined(__linux__)
+    CPU_ZERO(available);
+    if (sched_getaffinity(0, sizeof(*available), available) != 0)
+    {
+        return 0;
+    }
+    return CPU_COUNT(available);
+#else
+    return 0;
+#endif
+}
+
+// Restricts every thread of the process to the first `cores` of the available cores. Threads
+// created afterwards inherit the restriction.
+bool RestrictToCores(const CoreMask &available, int cores)
+{
+#if defined(_WIN32)
+    DWORD_PTR restricted = 0;
+    for (DWORD_PTR mask = available; mask != 0 && cores > 0; mask &= mask - 1, --cores)
+    {
+        restricted |= mask & (~mask + 1);
+    }
+    return SetProcessAffinityMask(GetCurrentProcess(), restricted) != 0;
+#elif defined(__linux__)
+    cpu_set_t restricted;
+    CPU_ZERO(&restricted);
+    for (int cpu = 0; cpu < CPU_SETSIZE && cores > 0; ++cpu)
+    {
+        if (CPU_ISSET(cpu, &available))
+        {
+            CPU_SET(cpu, &restricted);
+            --cores;
+        }
+    }
+    // The affinity of a Linux thread is its own, so the worker threads which already exist are
+    // moved one by one.
+    DIR *tasks = opendir("/proc/self/task");
+    if (tasks == nullptr)
+    {
+        return false;
+    }
+    bool success = true;
+    while (dirent *task = readdir(tasks))
+    {
+        if (task->d_name[0] != '.')
+        {
+            success = sched_setaffinity(atoi(task->d_name), sizeof(restricted), &restricted) == 0 &&
+                      success;
+        }
+    }
+    closedir(tasks);
+    return success;
+#else
+    return false;
+#endif
+}
+
+}  // anonymous namespace
+
+int main(int argc, char **argv)
+{
+    const std::string corpusPath =
+        workloads::GetArgument(argc, argv, "--corpus", "workloads/shaders");
+    const std::string backend = workloads::GetArgument(argc, argv, "--backend", "null");
+    const int variants = atoi(workloads::GetArgument(argc, argv, "--variants", "64").c_str());
+    const int maxCores = atoi(workloads::GetArgument(argc, argv, "--max-cores", "16").c_str());
+    const int maxPending =
+        atoi(workloads::GetArgument(argc, argv, "--max-pending", "0").c_str());
+
+    const std::vector<workloads::ShaderSource> corpus = workloads::LoadShaderCorpus(corpusPath);
+    const std::vector<workloads::ShaderProgramSource> programs =
+        workloads::GetCorpusPrograms(corpus);
+
+    CoreMask available;
+    const int availableCores = GetAvailableCores(&available);
+    std::vector<int> coreCounts;
+    for (int cores = 1; cores <= maxCores && cores <= availableCores; cores *= 2)
+    {
+        coreCounts.push_back(cores);
+    }
+    if (coreCounts.empty())
+    {
+        fprintf(stderr, "Cannot restrict the cores on this platform, running on all of them.\n");
+        coreCounts.push_back(0);
+    }
+
+    workloads::EGLWindow window;
+    if (!workloads::InitializeEGLWindow(backend, &window))
+    {
+        workloads::DestroyEGLWindow(&window);
+        return EXIT_FAILURE;
+    }
+
+    printf("Backend: %s, %zu programs x %d variants, %d cores available\n", backend.c_str(),
+           programs.size(), variants, availableCores);
+
+    bool linked       = true;
+    double baselineMs = 0.0;
+    for (size_t round = 0; round < coreCounts.size(); ++round)
+    {
+        const int cores = coreCounts[round];
+        if (cores > 0 && !RestrictToCores(available, cores))
+        {
+            fprintf(stderr, "Could not restrict the process to %d cores.\n", cores);
+            workloads::DestroyEGLWindow(&window);
+            return EXIT_FAILURE;
+        }
+
+        std::vector<std::string> sources;
+        for (int variant = 0; variant < variants; ++variant)
+        {
+            for (const workloads::ShaderProgramSource &program : programs)
+            {
+                sources.push_back(MakeVariant(program.vertex->source, round, variant));
+                sources.push_back(MakeVariant(program.fragment->source, round, variant));
+            }
+        }
+
+        workloads::Timer timer;
+        godot_angle::ProgramBatch batch(maxPending);
+        for (size_t i = 0; i < sources.size(); i += 2)
+        {
+            batch.add(sources[i].c_str(), sources[i + 1].c_str());
+        }
+        batch.wait();
+        double elapsedMs = timer.elapsedMs();
+
+        for (GLuint program : batch.release())
+        {
+            GLint status = GL_FALSE;
+            glGetProgramiv(program, GL_LINK_STATUS, &status);
+            linked = linked && status == GL_TRUE;
+            glDeleteProgram(program);
+        }
+
+        if (round == 0)
+        {
+            baselineMs = elapsedMs;
+        }
+        const std::string label = cores > 0 ? std::to_string(cores) + " cores" : "all cores";
+        printf("%-10s %10.2f ms %6.2fx\n", label.c_str(), elapsedMs, baselineMs / elapsedMs);
+    }
+
+    workloads::DestroyEGLWindow(&window);
+    if (!linked)
+    {
+        fprintf(stderr, "Some programs failed to link.\n");
+    }
+    return linked ? EXIT_SUCCESS : EXIT_FAILURE;
+}
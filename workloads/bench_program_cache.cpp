@@ -0,0 +1,137 @@
+//
+// Link time of the shader corpus with the disk program cache attached. Run it twice: the first
+// run compiles everything and fills the cache, the second one loads the programs from it, like a
+// second launch of Godot would. `--clear` empties the cache first.
+//
+// Translated shaders are cached as well, so compile and link are timed separately: with a warm
+// cache, compilation is a shader cache lookup and linking a program cache lookup. Run the second
+// pass with `--no-program-cache` to time warm shaders followed by full links, as happens when a
+// program was evicted or the driver rejects its binary; `--no-shader-cache` leaves the shader
+// cache disabled to compare against.
+//
+// Requires building with `disk_blob_cache=yes`.
+//
+// Usage: bench_program_cache [--corpus=workloads/shaders] [--backend=null|gl_null|native]
+//                            [--cache-dir=program_cache] [--clear] [--no-shader-cache]
+//                            [--no-program-cache]
+//
+
+#include "workload_utils.h"
+
+#include "DiskBlobCache.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <iterator>
+#include <string>
+#include <vector>
+
+int main(int argc, char **argv)
+{
+    const std::string corpusPath =
+        workloads::GetArgument(argc, argv, "--corpus", "workloads/shaders");
+    const std::string backend  = workloads::GetArgument(argc, argv, "--backend", "native");
+    const std::string cacheDir = workloads::GetArgument(argc, argv, "--cache-dir", "program_cache");
+    const bool shaderCache     = !workloads::HasArgument(argc, argv, "--no-shader-cache");
+    const bool programCache    = !workloads::HasArgument(argc, argv, "--no-program-cache");
+
+    std::error_code error;
+    if (workloads::HasArgument(argc, argv, "--clear"))
+    {
+        std::filesystem::remove_all(cacheDir, error);
+    }
+    size_t cachedFiles = 0;
+    for (auto iter = std::filesystem::directory_iterator(cacheDir, error);
+         iter != std::filesystem::directory_iterator(); iter.increment(error))
+    {
+        ++cachedFiles;
+    }
+
+    std::vector<const char *> features;
+    if (shaderCache)
+    {
+        features.assign(std::begin(godot_angle::kDiskBlobCacheDisplayFeatures),
+                        std::end(godot_angle::kDiskBlobCacheDisplayFeatures) - 1);
+    }
+    if (!programCache)
+    {
+        features.push_back("disableProgramCaching");
+    }
+    features.push_back(nullptr);
+
+    const std::vector<workloads::ShaderSource> corpus = workloads::LoadShaderCorpus(corpusPath);
+    workloads::EGLWindow window;
+    if (!workloads::InitializeEGLWindow(backend, &window, features.data()))
+    {
+        workloads::DestroyEGLWindow(&window);
+        return EXIT_FAILURE;
+    }
+    if (!godot_angle::AttachDiskBlobCache(window.display, cacheDir.c_str(), 256 << 20))
+    {
+        fprintf(stderr, "Could not attach the disk cache at %s.\n", cacheDir.c_str());
+        workloads::DestroyEGLWindow(&window);
+        return EXIT_FAILURE;
+    }
+
+    const std::vector<workloads::ShaderProgramSource> sources =
+        workloads::GetCorpusPrograms(corpus);
+
+    // ANGLE may translate in the background, querying the compile status waits for it.
+    bool compiled = true;
+    std::vector<GLuint> shaders;
+    workloads::Timer compileTimer;
+    for (const workloads::ShaderProgramSource &source : sources)
+    {
+        shaders.push_back(workloads::CompileShader(GL_VERTEX_SHADER, source.vertex->source));
+        shaders.push_back(workloads::CompileShader(GL_FRAGMENT_SHADER, source.fragment->source));
+    }
+    for (GLuint shader : shaders)
+    {
+        GLint status = GL_FALSE;
+        glGetShaderiv(shader, GL_COMPILE_STATUS, &status);
+        compiled = compiled && status == GL_TRUE;
+    }
+    double compileMs = compileTimer.elapsedMs();
+
+    bool linked = true;
+    std::vector<GLuint> programs;
+    workloads::Timer linkTimer;
+    for (size_t i = 0; i < shaders.size(); i += 2)
+    {
+        GLuint program = glCreateProgram();
+        glAttachShader(program, shaders[i]);
+        glAttachShader(program, shaders[i + 1]);
+        glLinkProgram(program);
+        programs.push_back(program);
+    }
+    for (GLuint program : programs)
+    {
+        GLint status = GL_FALSE;
+        glGetProgramiv(program, GL_LINK_STATUS, &status);
+        linked = linked && status == GL_TRUE;
+    }
+    double linkMs = linkTimer.elapsedMs();
+
+    printf("Backend: %s, %zu files in the cache before the run\n", backend.c_str(), cachedFiles);
+    printf("Shader cache %s, program cache %s\n", shaderCache ? "on" : "off",
+           programCache ? "on" : "off");
+    printf("Compiled %zu shaders in %.2f ms\n", shaders.size(), compileMs);
+    printf("Linked %zu programs in %.2f ms\n", programs.size(), linkMs);
+
+    for (GLuint shader : shaders)
+    {
+        glDeleteShader(shader);
+    }
+    for (GLuint program : programs)
+    {
+        glDeleteProgram(program);
+    }
+    workloads::DestroyEGLWindow(&window);
+    godot_angle::ShutdownDiskBlobCache();
+    if (!compiled || !linked)
+    {
+        fprintf(stderr, "Some shaders failed to compile or link.\n");
+    }
+    return compiled && linked ? EXIT_SUCCESS : EXIT_FAILURE;
+}
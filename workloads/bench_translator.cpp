@@ -0,0 +1,136 @@
+//
+// Shader translator throughput over the shader corpus, for every output built into
+// libANGLE_translator. Only the translator is linked, so it runs headless anywhere; build with
+// `translator_all_backends=yes` to include the HLSL and MSL outputs on every platform.
+//
+// Each output is timed in three runs over the corpus, which give the phases by difference:
+//   preprocess - angle::pp::Preprocessor alone, lexing every token.
+//   parse      - sh::Compile without object code: parsing, validation and the AST simplification
+//                every output shares, minus the preprocessing.
+//   backend    - sh::Compile with object code: the output's tree_ops passes and code generation,
+//                minus the two phases above.
+// The tree_ops passes and code generation are not timed apart: both only run with object code, so
+// no run isolates one of them. Splitting them needs a timing scope between the two in
+// TCompiler::compile, which ANGLE does not have.
+//
+// Usage: bench_translator [--corpus=workloads/shaders] [--rounds=N]
+//
+
+#include "preprocessor_utils.h"
+#include "workload_utils.h"
+
+#include <GLSLANG/ShaderLang.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+double TimePreprocessor(const std::vector<workloads::ShaderSource> &corpus, int rounds)
+{
+    workloads::Timer timer;
+    for (int round = 0; round < rounds; ++round)
+    {
+        for (const workloads::ShaderSource &shader : corpus)
+        {
+            workloads::Preprocess(shader.source);
+        }
+    }
+    return timer.elapsedMs();
+}
+
+// Returns the time spent in sh::Compile, or a negative value if a shader failed to translate.
+double TimeCompile(const std::vector<workloads::ShaderSource> &corpus,
+                   ShShaderOutput output,
+                   const ShCompileOptions &options,
+                   int rounds)
+{
+    ShBuiltInResources resources;
+    workloads::InitTranslatorResources(&resources);
+
+    // Like gl::Compiler, one translator per shader type is reused for every shader.
+    ShHandle vertexCompiler =
+        sh::ConstructCompiler(GL_VERTEX_SHADER, SH_GLES3_SPEC, output, &resources);
+    ShHandle fragmentCompiler =
+        sh::ConstructCompiler(GL_FRAGMENT_SHADER, SH_GLES3_SPEC, output, &resources);
+
+    double elapsedMs = 0.0;
+    workloads::Timer timer;
+    for (int round = 0; round < rounds && elapsedMs >= 0.0; ++round)
+    {
+        for (const workloads::ShaderSource &shader : corpus)
+        {
+            ShHandle compiler =
+                shader.type == GL_VERTEX_SHADER ? vertexCompiler : fragmentCompiler;
+            const char *strings[] = {shader.source.c_str()};
+            if (!sh::Compile(compiler, strings, 1, options))
+            {
+                fprintf(stderr, "Could not translate %s:\n%s\n", shader.name.c_str(),
+                        sh::GetInfoLog(compiler).c_str());
+                elapsedMs = -1.0;
+                break;
+            }
+        }
+    }
+    if (elapsedMs >= 0.0)
+    {
+        elapsedMs = timer.elapsedMs();
+    }
+
+    sh::Destruct(vertexCompiler);
+    sh::Destruct(fragmentCompiler);
+    return elapsedMs;
+}
+
+}  // anonymous namespace
+
+int main(int argc, char **argv)
+{
+    const std::string corpusPath =
+        workloads::GetArgument(argc, argv, "--corpus", "workloads/shaders");
+    const int rounds = atoi(workloads::GetArgument(argc, argv, "--rounds", "20").c_str());
+
+    const std::vector<workloads::ShaderSource> corpus = workloads::LoadShaderCorpus(corpusPath);
+    if (corpus.empty())
+    {
+        fprintf(stderr, "No shaders in %s.\n", corpusPath.c_str());
+        return EXIT_FAILURE;
+    }
+
+    sh::Initialize();
+
+    ShCompileOptions frontendOptions;
+    frontendOptions.variables = true;
+    ShCompileOptions fullOptions = frontendOptions;
+    fullOptions.objectCode       = true;
+
+    const double shaderCount = static_cast<double>(corpus.size()) * rounds;
+    printf("%zu shaders, %d rounds, times in ms per round\n", corpus.size(), rounds);
+    printf("%-20s %10s %10s %10s %10s %12s\n", "Output", "preprocess", "parse", "backend",
+           "total", "shaders/s");
+
+    bool success = true;
+    for (const workloads::TranslatorOutput &output : workloads::kTranslatorOutputs)
+    {
+        // The preprocessor does not depend on the output, but timing it next to the other runs
+        // keeps the three measurements under the same conditions.
+        double preprocessMs = TimePreprocessor(corpus, rounds);
+        double frontendMs   = TimeCompile(corpus, output.output, frontendOptions, rounds);
+        double fullMs       = TimeCompile(corpus, output.output, fullOptions, rounds);
+        if (frontendMs < 0.0 || fullMs < 0.0)
+        {
+            success = false;
+            continue;
+        }
+
+        printf("%-20s %10.3f %10.3f %10.3f %10.3f %12.0f\n", output.name, preprocessMs / rounds,
+               (frontendMs - preprocessMs) / rounds, (fullMs - frontendMs) / rounds,
+               fullMs / rounds, shaderCount / (fullMs / 1000.0));
+    }
+
+    sh::Finalize();
+    return success ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,126 @@
+//
+// Compression throughput of program binaries, which egl::BlobCache stores through the same
+// zlib_internal gzip helpers. The blobs are real: the shader corpus is linked through ANGLE and
+// read back with glGetProgramBinary.
+//
+// Usage: bench_zlib [--corpus=workloads/shaders] [--backend=null|gl_null|native] [--rounds=N]
+//
+
+#include "workload_utils.h"
+
+#include "compression_utils_portable.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+std::vector<std::vector<uint8_t>> GetProgramBinaries(
+    const std::vector<workloads::ShaderSource> &corpus)
+{
+    std::vector<std::vector<uint8_t>> binaries;
+    for (const workloads::ShaderProgramSource &source : workloads::GetCorpusPrograms(corpus))
+    {
+        GLuint program = workloads::LinkProgram(source);
+        if (program == 0)
+        {
+            continue;
+        }
+
+        GLint length = 0;
+        glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+        std::vector<uint8_t> binary(length);
+        GLenum format = 0;
+        glGetProgramBinary(program, length, nullptr, &format, binary.data());
+        if (length > 0)
+        {
+            printf("%-24s %8d bytes\n", source.name.c_str(), length);
+            binaries.push_back(std::move(binary));
+        }
+        glDeleteProgram(program);
+    }
+    return binaries;
+}
+
+}  // anonymous namespace
+
+int main(int argc, char **argv)
+{
+    const std::string corpusPath =
+        workloads::GetArgument(argc, argv, "--corpus", "workloads/shaders");
+    const std::string backend = workloads::GetArgument(argc, argv, "--backend", "null");
+    const int rounds = atoi(workloads::GetArgument(argc, argv, "--rounds", "200").c_str());
+
+    workloads::EGLWindow window;
+    if (!workloads::InitializeEGLWindow(backend, &window))
+    {
+        workloads::DestroyEGLWindow(&window);
+        return EXIT_FAILURE;
+    }
+    std::vector<std::vector<uint8_t>> binaries =
+        GetProgramBinaries(workloads::LoadShaderCorpus(corpusPath));
+    workloads::DestroyEGLWindow(&window);
+    if (binaries.empty())
+    {
+        fprintf(stderr, "No program binaries to compress.\n");
+        return EXIT_FAILURE;
+    }
+
+    size_t totalBytes      = 0;
+    size_t compressedBytes = 0;
+    std::vector<std::vector<uint8_t>> compressed(binaries.size());
+    std::vector<uint8_t> uncompressed;
+
+    double compressMs   = 0.0;
+    double uncompressMs = 0.0;
+    for (int round = 0; round < rounds; ++round)
+    {
+        workloads::Timer timer;
+        for (size_t i = 0; i < binaries.size(); ++i)
+        {
+            uLongf length = zlib_internal::GzipExpectedCompressedSize(binaries[i].size());
+            compressed[i].resize(length);
+            if (zlib_internal::GzipCompressHelper(compressed[i].data(), &length, binaries[i].data(),
+                                                  binaries[i].size(), nullptr, nullptr) != Z_OK)
+            {
+                fprintf(stderr, "Compression failed.\n");
+                return EXIT_FAILURE;
+            }
+            compressed[i].resize(length);
+        }
+        compressMs += timer.elapsedMs();
+
+        timer.restart();
+        for (size_t i = 0; i < binaries.size(); ++i)
+        {
+            uLongf length = binaries[i].size();
+            uncompressed.resize(length);
+            if (zlib_internal::GzipUncompressHelper(uncompressed.data(), &length,
+                                                    compressed[i].data(),
+                                                    compressed[i].size()) != Z_OK ||
+                length != binaries[i].size())
+            {
+                fprintf(stderr, "Decompression failed.\n");
+                return EXIT_FAILURE;
+            }
+        }
+        uncompressMs += timer.elapsedMs();
+    }
+
+    for (size_t i = 0; i < binaries.size(); ++i)
+    {
+        totalBytes += binaries[i].size();
+        compressedBytes += compressed[i].size();
+    }
+
+    const double totalMB = static_cast<double>(totalBytes) * rounds / (1024.0 * 1024.0);
+    printf("%zu blobs, %zu bytes, ratio %.2f\n", binaries.size(), totalBytes,
+           static_cast<double>(totalBytes) / compressedBytes);
+    printf("Compress:   %8.1f MB/s\n", totalMB / (compressMs / 1000.0));
+    printf("Decompress: %8.1f MB/s\n", totalMB / (uncompressMs / 1000.0));
+    return EXIT_SUCCESS;
+}
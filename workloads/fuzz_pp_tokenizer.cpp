@@ -0,0 +1,309 @@
+//
+// Differential check of godot_angle::PreprocessorScanner against the flex generated
+// angle::pp::Tokenizer from Tokenizer.l. The corpus shaders, and `--iterations` random
+// mutations of them, are tokenized by both, comparing the type, flags, location and text of every
+// token and the diagnostics reported on the way. Mutations splice in what the two are most likely
+// to disagree on: line continuations, line endings, comment delimiters, number prefixes, suffixes
+// and exponents, operators, overlong tokens and stray bytes. The source is also split into
+// several strings, as glShaderSource allows, to cover file numbers. The first difference is
+// printed with the input which caused it.
+//
+// The corpus is then tokenized `--rounds` times by both, to compare their speed.
+//
+// With `fast_pp_tokenizer=yes`, the flex tokenizer is linked in from its own object, and native
+// builds run this over the corpus before libANGLE is archived with the scanner.
+//
+// Usage: fuzz_pp_tokenizer [--corpus=workloads/shaders] [--iterations=N] [--seed=N] [--rounds=N]
+//
+
+#include "workload_utils.h"
+
+#include "PreprocessorScanner.h"
+
+#include "compiler/preprocessor/DiagnosticsBase.h"
+#include "compiler/preprocessor/Token.h"
+#include "compiler/preprocessor/Tokenizer.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+// Tokenizer's default, and the translator's limit for WebGL shaders.
+constexpr size_t kMaxTokenSize = 256;
+
+struct TokenizedSource
+{
+    std::vector<std::string> tokens;
+    std::vector<std::string> diagnostics;
+};
+
+class RecordingDiagnostics : public angle::pp::Diagnostics
+{
+  public:
+    explicit RecordingDiagnostics(std::vector<std::string> *reports) : mReports(reports) {}
+
+  protected:
+    void print(ID id, const angle::pp::SourceLocation &loc, const std::string &text) override
+    {
+        if (mReports != nullptr)
+        {
+            mReports->push_back(std::to_string(id) + " at " + std::to_string(loc.file) + ":" +
+                                std::to_string(loc.line) + " " + text);
+        }
+    }
+
+  private:
+    std::vector<std::string> *mReports;
+};
+
+std::string DescribeToken(const angle::pp::Token &token)
+{
+    return std::to_string(token.type) + " flags " + std::to_string(token.flags) + " at " +
+           std::to_string(token.location.file) + ":" + std::to_string(token.location.line) +
+           " '" + token.text + "'";
+}
+
+// Lexes until the end of the input, recording the tokens into `result` when it is not null.
+template <typename LexFunc>
+void Tokenize(LexFunc &&lex, TokenizedSource *result)
+{
+    angle::pp::Token token;
+    do
+    {
+        lex(&token);
+        if (result != nullptr)
+        {
+            result->tokens.push_back(DescribeToken(token));
+        }
+    } while (token.type != angle::pp::Token::LAST);
+}
+
+class SourceStrings
+{
+  public:
+    explicit SourceStrings(const std::vector<std::string> &strings)
+    {
+        for (const std::string &string : strings)
+        {
+            mPointers.push_back(string.data());
+            mLengths.push_back(static_cast<int>(string.size()));
+        }
+    }
+
+    size_t count() const { return mPointers.size(); }
+    const char *const *pointers() const { return mPointers.data(); }
+    const int *lengths() const { return mLengths.data(); }
+
+  private:
+    std::vector<const char *> mPointers;
+    std::vector<int> mLengths;
+};
+
+void TokenizeWithFlex(const std::vector<std::string> &strings, TokenizedSource *result)
+{
+    SourceStrings source(strings);
+    RecordingDiagnostics diagnostics(result != nullptr ? &result->diagnostics : nullptr);
+    angle::pp::Tokenizer tokenizer(&diagnostics);
+    tokenizer.init(source.count(), source.pointers(), source.lengths());
+    tokenizer.setMaxTokenSize(kMaxTokenSize);
+    Tokenize([&](angle::pp::Token *token) { tokenizer.lex(token); }, result);
+}
+
+void TokenizeWithScanner(const std::vector<std::string> &strings, TokenizedSource *result)
+{
+    SourceStrings source(strings);
+    RecordingDiagnostics diagnostics(result != nullptr ? &result->diagnostics : nullptr);
+    angle::pp::Tokenizer::Context context;
+    context.diagnostics  = &diagnostics;
+    context.input        = angle::pp::Input(source.count(), source.pointers(), source.lengths());
+    context.leadingSpace = false;
+    context.lineStart    = true;
+    godot_angle::PreprocessorScanner scanner(&context);
+    scanner.restart();
+    Tokenize([&](angle::pp::Token *token) { scanner.lex(token, kMaxTokenSize); }, result);
+}
+
+std::string Escape(const std::string &text)
+{
+    std::string escaped;
+    for (unsigned char c : text)
+    {
+        if (c == '\\' || c < 0x20 || c >= 0x7F)
+        {
+            char buffer[8];
+            snprintf(buffer, sizeof(buffer), "\\x%02x", c);
+            escaped += c == '\n' ? std::string("\\n\n") : std::string(buffer);
+        }
+        else
+        {
+            escaped += static_cast<char>(c);
+        }
+    }
+    return escaped;
+}
+
+void PrintDifference(const char *what,
+                     const std::vector<std::string> &flex,
+                     const std::vector<std::string> &scanner)
+{
+    size_t index = 0;
+    while (index < flex.size() && index < scanner.size() && flex[index] == scanner[index])
+    {
+        ++index;
+    }
+    fprintf(stderr, "%s %zu differs:\n  flex:    %s\n  scanner: %s\n", what, index,
+            index < flex.size() ? Escape(flex[index]).c_str() : "(none)",
+            index < scanner.size() ? Escape(scanner[index]).c_str() : "(none)");
+}
+
+bool Check(const std::vector<std::string> &strings)
+{
+    TokenizedSource flex;
+    TokenizedSource scanner;
+    TokenizeWithFlex(strings, &flex);
+    TokenizeWithScanner(strings, &scanner);
+    if (flex.tokens == scanner.tokens && flex.diagnostics == scanner.diagnostics)
+    {
+        return true;
+    }
+
+    if (flex.tokens != scanner.tokens)
+    {
+        PrintDifference("Token", flex.tokens, scanner.tokens);
+    }
+    else
+    {
+        PrintDifference("Diagnostic", flex.diagnostics, scanner.diagnostics);
+    }
+    for (size_t i = 0; i < strings.size(); ++i)
+    {
+        fprintf(stderr, "String %zu:\n%s\n", i, Escape(strings[i]).c_str());
+    }
+    return false;
+}
+
+const char *const kFragments[] = {
+    "\\\n", "\\\r\n", "\\\r", "\\", "\\\\\n", "\n", "\r", "\r\n", "\n\r", "/*", "*/", "/**/",
+    "//", "/", "*", "#", "##", " #", "\t", "\v", "\f", " ", ".", "..", "0", "00", "09", "0x",
+    "0X1f", "0xg", "1", "123", "u", "U", "uu", "f", "F", "e", "E", "e+", "E-", "1.", ".5", "1e10",
+    "2e+", "3.e5F", "1.5e-3f", "0777u", "_", "a", "_a1", "float", "<", ">", "<<", ">>", "<<=",
+    ">>=", "=", "==", "!", "!=", "&", "&&", "|", "||", "^", "^^", "+", "++", "-", "--", "%", "~",
+    "(", ")", "[", "]", "{", "}", ";", ",", ":", "?", "@", "$", "`", "\"", "'", "\x80", "\xff",
+};
+
+std::string Mutate(const std::string &source, std::mt19937 *random)
+{
+    std::string mutated = source;
+    const int edits     = std::uniform_int_distribution<int>(1, 8)(*random);
+    for (int edit = 0; edit < edits; ++edit)
+    {
+        const size_t position = std::uniform_int_distribution<size_t>(0, mutated.size())(*random);
+        switch (std::uniform_int_distribution<int>(0, 4)(*random))
+        {
+            case 0:
+            case 1:
+            {
+                const size_t fragment = std::uniform_int_distribution<size_t>(
+                    0, sizeof(kFragments) / sizeof(kFragments[0]) - 1)(*random);
+                mutated.insert(position, kFragments[fragment]);
+                break;
+            }
+            case 2:
+                mutated.erase(position, std::uniform_int_distribution<size_t>(1, 16)(*random));
+                break;
+            case 3:
+                mutated.insert(position, 1, static_cast<char>((*random)() & 0xFF));
+                break;
+            case 4:
+                mutated.insert(position, kMaxTokenSize + 1, 'a');
+                break;
+        }
+    }
+    return mutated;
+}
+
+std::vector<std::string> Split(const std::string &source, std::mt19937 *random)
+{
+    std::vector<std::string> strings;
+    const int splits = std::uniform_int_distribution<int>(0, 3)(*random);
+    size_t begin     = 0;
+    for (int split = 0; split < splits; ++split)
+    {
+        const size_t end = std::uniform_int_distribution<size_t>(begin, source.size())(*random);
+        strings.push_back(source.substr(begin, end - begin));
+        begin = end;
+    }
+    strings.push_back(source.substr(begin));
+    return strings;
+}
+
+}  // anonymous namespace
+
+int main(int argc, char **argv)
+{
+    const std::string corpusPath =
+        workloads::GetArgument(argc, argv, "--corpus", "workloads/shaders");
+    const int iterations =
+        atoi(workloads::GetArgument(argc, argv, "--iterations", "100000").c_str());
+    const unsigned int seed =
+        static_cast<unsigned int>(atoi(workloads::GetArgument(argc, argv, "--seed", "1").c_str()));
+    const int rounds = atoi(workloads::GetArgument(argc, argv, "--rounds", "20").c_str());
+
+    const std::vector<workloads::ShaderSource> corpus = workloads::LoadShaderCorpus(corpusPath);
+    if (corpus.empty())
+    {
+        fprintf(stderr, "No shaders in %s.\n", corpusPath.c_str());
+        return EXIT_FAILURE;
+    }
+
+    for (const workloads::ShaderSource &shader : corpus)
+    {
+        if (!Check({shader.source}))
+        {
+            fprintf(stderr, "Corpus shader %s differs.\n", shader.name.c_str());
+            return EXIT_FAILURE;
+        }
+    }
+
+    std::mt19937 random(seed);
+    for (int iteration = 0; iteration < iterations; ++iteration)
+    {
+        const std::string &source =
+            corpus[std::uniform_int_distribution<size_t>(0, corpus.size() - 1)(random)].source;
+        if (!Check(Split(Mutate(source, &random), &random)))
+        {
+            fprintf(stderr, "Mutation %d with seed %u differs.\n", iteration, seed);
+            return EXIT_FAILURE;
+        }
+    }
+    printf("%zu shaders and %d mutations tokenized the same.\n", corpus.size(), iterations);
+
+    workloads::Timer flexTimer;
+    for (int round = 0; round < rounds; ++round)
+    {
+        for (const workloads::ShaderSource &shader : corpus)
+        {
+            TokenizeWithFlex({shader.source}, nullptr);
+        }
+    }
+    const double flexMs = flexTimer.elapsedMs();
+
+    workloads::Timer scannerTimer;
+    for (int round = 0; round < rounds; ++round)
+    {
+        for (const workloads::ShaderSource &shader : corpus)
+        {
+            TokenizeWithScanner({shader.source}, nullptr);
+        }
+    }
+    const double scannerMs = scannerTimer.elapsedMs();
+
+    printf("Tokenizing the corpus: flex %.3f ms, scanner %.3f ms per round, %.2fx\n",
+           flexMs / rounds, scannerMs / rounds, flexMs / scannerMs);
+    return EXIT_SUCCESS;
+}
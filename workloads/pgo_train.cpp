@@ -0,0 +1,395 @@
+//
+// Profile-guided optimization training driver.
+//
+// Build it with `scons pgo_train optimize=pgo_generate`, run it from the repository root, then
+// rebuild the archives with `optimize=pgo_use`. Only a training run which completes validates the
+// profile stamp the build left pending in `--pgo-dir`, which has to match the build's `pgo_dir`;
+// `optimize=pgo_use` refuses profiles without it. The workload is deterministic: it translates the
+// shader corpus with every translator backend built for this platform, links the corpus through
+// gl::Context, issues draw calls with varying state to exercise draw validation and the state
+// cache, and uploads textures in formats that go through the image_util loaders.
+//
+// Usage: pgo_train [--corpus=workloads/shaders] [--backend=native|null|gl_null] [--frames=N]
+//                  [--pgo-dir=pgo]
+//
+
+#include "workload_utils.h"
+
+#include <GLSLANG/ShaderLang.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+bool TrainTranslator(const std::vector<workloads::ShaderSource> &corpus)
+{
+    ShBuiltInResources resources;
+    workloads::InitTranslatorResources(&resources);
+
+    ShCompileOptions options;
+    options.objectCode = true;
+    options.variables  = true;
+
+    bool success = true;
+    for (const workloads::TranslatorOutput &output : workloads::kTranslatorOutputs)
+    {
+        for (const workloads::ShaderSource &shader : corpus)
+        {
+            ShHandle compiler =
+                sh::ConstructCompiler(shader.type, SH_GLES3_SPEC, output.output, &resources);
+            const char *strings[] = {shader.source.c_str()};
+            if (!sh::Compile(compiler, strings, 1, options))
+            {
+                fprintf(stderr, "Could not translate %s:\n%s\n", shader.name.c_str(),
+                        sh::GetInfoLog(compiler).c_str());
+                success = false;
+            }
+            sh::Destruct(compiler);
+        }
+    }
+    return success;
+}
+
+struct DrawTextures
+{
+    GLuint texture2D     = 0;
+    GLuint textureCube   = 0;
+    GLuint textureShadow = 0;
+};
+
+struct DrawProgram
+{
+    GLuint program = 0;
+    GLuint vertexArray = 0;
+    std::vector<GLint> vec4Uniforms;
+};
+
+// Gives every active block, sampler and attribute of `program` valid data so the draws pass
+// validation on all backends.
+DrawProgram SetupDrawProgram(GLuint program,
+                             GLuint uniformBuffer,
+                             GLuint vertexBuffer,
+                             GLuint indexBuffer,
+                             const DrawTextures &textures)
+{
+    DrawProgram draw;
+    draw.program = program;
+    glUseProgram(program);
+
+    GLint blockCount = 0;
+    glGetProgramiv(program, GL_ACTIVE_UNIFORM_BLOCKS, &blockCount);
+    for (GLint block = 0; block < blockCount; ++block)
+    {
+        glUniformBlockBinding(program, block, block);
+    }
+
+    // Every sampler type gets its own range of units, so the bindings stay consistent between
+    // programs.
+    GLint uniformCount = 0;
+    glGetProgramiv(program, GL_ACTIVE_UNIFORMS, &uniformCount);
+    GLint texture2DUnit     = 0;
+    GLint textureCubeUnit   = 8;
+    GLint textureShadowUnit = 12;
+    for (GLint uniform = 0; uniform < uniformCount; ++uniform)
+    {
+        char name[256] = {};
+        GLint size     = 0;
+        GLenum type    = 0;
+        glGetActiveUniform(program, uniform, sizeof(name), nullptr, &size, &type, name);
+        GLint location = glGetUniformLocation(program, name);
+        if (location < 0)
+        {
+            continue;
+        }
+
+        switch (type)
+        {
+            case GL_SAMPLER_2D:
+                glActiveTexture(GL_TEXTURE0 + texture2DUnit);
+                glBindTexture(GL_TEXTURE_2D, textures.texture2D);
+                glUniform1i(location, texture2DUnit++);
+                break;
+            case GL_SAMPLER_CUBE:
+                glActiveTexture(GL_TEXTURE0 + textureCubeUnit);
+                glBindTexture(GL_TEXTURE_CUBE_MAP, textures.textureCube);
+                glUniform1i(location, textureCubeUnit++);
+                break;
+            case GL_SAMPLER_2D_SHADOW:
+                glActiveTexture(GL_TEXTURE0 + textureShadowUnit);
+                glBindTexture(GL_TEXTURE_2D, textures.textureShadow);
+                glUniform1i(location, textureShadowUnit++);
+                break;
+            case GL_FLOAT_VEC4:
+                draw.vec4Uniforms.push_back(location);
+                break;
+            default:
+                break;
+        }
+    }
+
+    glGenVertexArrays(1, &draw.vertexArray);
+    glBindVertexArray(draw.vertexArray);
+    glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer);
+
+    GLint attributeCount = 0;
+    glGetProgramiv(program, GL_ACTIVE_ATTRIBUTES, &attributeCount);
+    for (GLint attribute = 0; attribute < attributeCount; ++attribute)
+    {
+        char name[256] = {};
+        GLint size     = 0;
+        GLenum type    = 0;
+        glGetActiveAttrib(program, attribute, sizeof(name), nullptr, &size, &type, name);
+        GLint location = glGetAttribLocation(program, name);
+        if (location < 0)
+        {
+            continue;
+        }
+
+        glEnableVertexAttribArray(location);
+        if (type == GL_UNSIGNED_INT_VEC4 || type == GL_INT_VEC4)
+        {
+            glVertexAttribIPointer(location, 4, GL_UNSIGNED_BYTE, 16, nullptr);
+        }
+        else
+        {
+            glVertexAttribPointer(location, 4, GL_FLOAT, GL_FALSE, 16, nullptr);
+        }
+    }
+
+    for (GLint block = 0; block < blockCount; ++block)
+    {
+        glBindBufferBase(GL_UNIFORM_BUFFER, block, uniformBuffer);
+    }
+    return draw;
+}
+
+void UploadTextures(GLuint texture)
+{
+    struct UploadFormat
+    {
+        GLenum internalFormat;
+        GLenum format;
+        GLenum type;
+    };
+    // Formats without a native equivalent on most backends, so the upload goes through an
+    // image_util load function.
+    constexpr UploadFormat kFormats[] = {
+        {GL_RGB, GL_RGB, GL_UNSIGNED_BYTE},
+        {GL_LUMINANCE, GL_LUMINANCE, GL_UNSIGNED_BYTE},
+        {GL_LUMINANCE_ALPHA, GL_LUMINANCE_ALPHA, GL_UNSIGNED_BYTE},
+        {GL_ALPHA, GL_ALPHA, GL_UNSIGNED_BYTE},
+        {GL_RGBA4, GL_RGBA, GL_UNSIGNED_SHORT_4_4_4_4},
+        {GL_RGB5_A1, GL_RGBA, GL_UNSIGNED_SHORT_5_5_5_1},
+        {GL_RGB565, GL_RGB, GL_UNSIGNED_SHORT_5_6_5},
+        {GL_RGB16F, GL_RGB, GL_FLOAT},
+        {GL_RGBA16F, GL_RGBA, GL_HALF_FLOAT},
+        {GL_R11F_G11F_B10F, GL_RGB, GL_FLOAT},
+        {GL_SRGB8_ALPHA8, GL_RGBA, GL_UNSIGNED_BYTE},
+    };
+    constexpr GLsizei kSize = 128;
+
+    std::vector<uint8_t> pixels(kSize * kSize * 16);
+    for (size_t i = 0; i < pixels.size(); ++i)
+    {
+        pixels[i] = static_cast<uint8_t>((i * 2654435761u) >> 24);
+    }
+
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    for (const UploadFormat &format : kFormats)
+    {
+        glTexImage2D(GL_TEXTURE_2D, 0, format.internalFormat, kSize, kSize, 0, format.format,
+                     format.type, pixels.data());
+        glTexSubImage2D(GL_TEXTURE_2D, 0, kSize / 4, kSize / 4, kSize / 2, kSize / 2, format.format,
+                        format.type, pixels.data());
+    }
+
+    // ETC2 is emulated by decompressing on upload on desktop class backends.
+    constexpr GLenum kCompressedFormats[] = {GL_COMPRESSED_RGB8_ETC2,
+                                             GL_COMPRESSED_RGBA8_ETC2_EAC, GL_COMPRESSED_R11_EAC};
+    constexpr GLsizei kBlockBytes[]       = {8, 16, 8};
+    for (size_t i = 0; i < sizeof(kCompressedFormats) / sizeof(kCompressedFormats[0]); ++i)
+    {
+        GLsizei imageSize = (kSize / 4) * (kSize / 4) * kBlockBytes[i];
+        glCompressedTexImage2D(GL_TEXTURE_2D, 0, kCompressedFormats[i], kSize, kSize, 0,
+                               imageSize, pixels.data());
+    }
+
+    // Leave a complete RGBA8 texture bound for the draws.
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, kSize, kSize, 0, GL_RGBA, GL_UNSIGNED_BYTE,
+                 pixels.data());
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+}
+
+bool TrainContext(const std::vector<workloads::ShaderSource> &corpus,
+                  const std::string &backend,
+                  int frames)
+{
+    workloads::EGLWindow window;
+    if (!workloads::InitializeEGLWindow(backend, &window))
+    {
+        workloads::DestroyEGLWindow(&window);
+        return false;
+    }
+
+    GLuint buffers[3] = {};
+    glGenBuffers(3, buffers);
+    const GLuint uniformBuffer = buffers[0];
+    const GLuint vertexBuffer  = buffers[1];
+    const GLuint indexBuffer   = buffers[2];
+
+    std::vector<uint8_t> zeros(64 * 1024);
+    glBindBuffer(GL_UNIFORM_BUFFER, uniformBuffer);
+    glBufferData(GL_UNIFORM_BUFFER, zeros.size(), zeros.data(), GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+    glBufferData(GL_ARRAY_BUFFER, 4 * 16, zeros.data(), GL_STATIC_DRAW);
+    const GLushort indices[] = {0, 1, 2, 0, 2, 3};
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
+
+    GLuint textureNames[3] = {};
+    glGenTextures(3, textureNames);
+    DrawTextures textures;
+    textures.texture2D     = textureNames[0];
+    textures.textureCube   = textureNames[1];
+    textures.textureShadow = textureNames[2];
+
+    UploadTextures(textures.texture2D);
+    glBindTexture(GL_TEXTURE_CUBE_MAP, textures.textureCube);
+    for (GLenum face = GL_TEXTURE_CUBE_MAP_POSITIVE_X; face <= GL_TEXTURE_CUBE_MAP_NEGATIVE_Z;
+         ++face)
+    {
+        glTexImage2D(face, 0, GL_RGBA8, 4, 4, 0, GL_RGBA, GL_UNSIGNED_BYTE, zeros.data());
+    }
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glBindTexture(GL_TEXTURE_2D, textures.textureShadow);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT24, 64, 64, 0, GL_DEPTH_COMPONENT,
+                 GL_UNSIGNED_INT, nullptr);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE);
+
+    std::vector<DrawProgram> draws;
+    for (const workloads::ShaderProgramSource &source : workloads::GetCorpusPrograms(corpus))
+    {
+        GLuint program = workloads::LinkProgram(source);
+        if (program != 0)
+        {
+            draws.push_back(
+                SetupDrawProgram(program, uniformBuffer, vertexBuffer, indexBuffer, textures));
+        }
+    }
+
+    for (int frame = 0; frame < frames; ++frame)
+    {
+        for (size_t drawIndex = 0; drawIndex < draws.size() * 64; ++drawIndex)
+        {
+            const DrawProgram &draw = draws[drawIndex % draws.size()];
+            glUseProgram(draw.program);
+            glBindVertexArray(draw.vertexArray);
+            for (GLint location : draw.vec4Uniforms)
+            {
+                glUniform4f(location, static_cast<float>(drawIndex), 0.5f, 0.25f, 1.0f);
+            }
+
+            if (drawIndex % 2 == 0)
+            {
+                glEnable(GL_BLEND);
+                glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+            }
+            else
+            {
+                glDisable(GL_BLEND);
+            }
+            if (drawIndex % 3 == 0)
+            {
+                glEnable(GL_DEPTH_TEST);
+                glDepthMask(drawIndex % 6 == 0);
+            }
+            else
+            {
+                glDisable(GL_DEPTH_TEST);
+            }
+            glEnable(GL_SCISSOR_TEST);
+            glScissor(0, 0, 16 + static_cast<GLint>(drawIndex % 240), 256);
+            glBindBufferRange(GL_UNIFORM_BUFFER, 0, uniformBuffer, (drawIndex % 4) * 256,
+                              16 * 1024);
+
+            glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_SHORT, nullptr);
+            glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+        }
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        eglSwapBuffers(window.display, window.surface);
+    }
+    glFinish();
+
+    GLenum error = glGetError();
+    if (error != GL_NO_ERROR)
+    {
+        fprintf(stderr, "GL error 0x%04X during training.\n", error);
+    }
+
+    for (const DrawProgram &draw : draws)
+    {
+        glDeleteVertexArrays(1, &draw.vertexArray);
+        glDeleteProgram(draw.program);
+    }
+    glDeleteTextures(3, textureNames);
+    glDeleteBuffers(3, buffers);
+    workloads::DestroyEGLWindow(&window);
+    return error == GL_NO_ERROR;
+}
+
+#if defined(PGO_GENERATE)
+// Renames the stamp setup_pgo wrote to pgo_dir into place, marking the profiles as complete.
+bool ValidateProfileStamp(const std::string &pgoDir)
+{
+    const std::string stampPath = pgoDir + "/profile.stamp";
+    std::remove(stampPath.c_str());
+    if (std::rename((stampPath + ".pending").c_str(), stampPath.c_str()) != 0)
+    {
+        fprintf(stderr, "No pending profile stamp in %s, pass the pgo_dir this was built with.\n",
+                pgoDir.c_str());
+        return false;
+    }
+    return true;
+}
+#endif
+
+}  // anonymous namespace
+
+int main(int argc, char **argv)
+{
+    const std::string corpusPath = workloads::GetArgument(argc, argv, "--corpus", "workloads/shaders");
+    const std::string backend    = workloads::GetArgument(argc, argv, "--backend", "native");
+    const int frames = atoi(workloads::GetArgument(argc, argv, "--frames", "100").c_str());
+
+    std::vector<workloads::ShaderSource> corpus = workloads::LoadShaderCorpus(corpusPath);
+    if (corpus.empty())
+    {
+        fprintf(stderr, "Empty shader corpus at %s.\n", corpusPath.c_str());
+        return EXIT_FAILURE;
+    }
+
+    workloads::Timer timer;
+    sh::Initialize();
+    bool success = TrainTranslator(corpus);
+    sh::Finalize();
+    printf("Translator workload: %.1f ms\n", timer.elapsedMs());
+
+    timer.restart();
+    success = TrainContext(corpus, backend, frames) && success;
+    printf("Context workload (%s): %.1f ms\n", backend.c_str(), timer.elapsedMs());
+
+#if defined(PGO_GENERATE)
+    success = success &&
+              ValidateProfileStamp(workloads::GetArgument(argc, argv, "--pgo-dir", "pgo"));
+#endif
+    return success ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,70 @@
+//
+// Runs angle::pp::Preprocessor on its own, for the drivers which time or count what the
+// preprocessor does apart from the rest of the translator.
+//
+
+#ifndef WORKLOADS_PREPROCESSOR_UTILS_H_
+#define WORKLOADS_PREPROCESSOR_UTILS_H_
+
+#include <GLSLANG/ShaderLang.h>
+
+#include "compiler/preprocessor/DiagnosticsBase.h"
+#include "compiler/preprocessor/DirectiveHandlerBase.h"
+#include "compiler/preprocessor/Preprocessor.h"
+#include "compiler/preprocessor/Token.h"
+
+#include <string>
+
+namespace workloads
+{
+
+// The preprocessor reports through these, the drivers only need the tokens.
+class NullDiagnostics : public angle::pp::Diagnostics
+{
+  protected:
+    void print(ID id, const angle::pp::SourceLocation &loc, const std::string &text) override {}
+};
+
+class NullDirectiveHandler : public angle::pp::DirectiveHandler
+{
+  public:
+    void handleError(const angle::pp::SourceLocation &loc, const std::string &msg) override {}
+    void handlePragma(const angle::pp::SourceLocation &loc,
+                      const std::string &name,
+                      const std::string &value,
+                      bool stdgl) override
+    {}
+    void handleExtension(const angle::pp::SourceLocation &loc,
+                         const std::string &name,
+                         const std::string &behavior) override
+    {}
+    void handleVersion(const angle::pp::SourceLocation &loc,
+                       int version,
+                       ShShaderSpec spec,
+                       angle::pp::MacroSet *macroSet) override
+    {}
+};
+
+// Lexes every token of `source` through a new preprocessor, and returns how many there were.
+inline size_t Preprocess(const std::string &source)
+{
+    NullDiagnostics diagnostics;
+    NullDirectiveHandler directiveHandler;
+    angle::pp::Preprocessor preprocessor(&diagnostics, &directiveHandler,
+                                         angle::pp::PreprocessorSettings(SH_GLES3_SPEC));
+    const char *strings[] = {source.c_str()};
+    preprocessor.init(1, strings, nullptr);
+
+    size_t tokenCount = 0;
+    angle::pp::Token token;
+    do
+    {
+        preprocessor.lex(&token);
+        ++tokenCount;
+    } while (token.type != angle::pp::Token::LAST);
+    return tokenCount;
+}
+
+}  // namespace workloads
+
+#endif  // WORKLOADS_PREPROCESSOR_UTILS_H_
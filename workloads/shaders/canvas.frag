@@ -0,0 +1,212 @@
+#version 300 es
+
+#define MAX_LIGHTS 8
+#define USE_LIGHTING
+#define USE_NINEPATCH
+#define MODE_LIGHT_SHADOW_SOFT
+
+precision highp float;
+precision highp int;
+
+in vec2 uv_interp;
+in vec4 color_interp;
+in vec2 vertex_interp;
+flat in uint instance_light_mask;
+
+layout(std140) uniform CanvasData {
+	mat4 projection_matrix;
+	mat4 screen_transform;
+	mat4 canvas_transform;
+	mat4 canvas_normal_transform;
+	vec4 canvas_modulation;
+	vec2 screen_pixel_size;
+	float time;
+	bool use_pixel_snap;
+	vec4 sdf_to_tex;
+	vec2 screen_to_sdf;
+	vec2 sdf_to_screen;
+	uint directional_light_count;
+	float tex_to_sdf;
+	uint pad1;
+	uint pad2;
+};
+
+struct Light {
+	mat2x4 texture_matrix;
+	mat2x4 shadow_matrix;
+	vec4 color;
+	uint shadow_color;
+	uint flags;
+	float shadow_pixel_size;
+	float height;
+	vec2 position;
+	float shadow_zfar_inv;
+	float shadow_y_ofs;
+	vec4 atlas_rect;
+};
+
+layout(std140) uniform LightData {
+	Light light_array[MAX_LIGHTS];
+};
+
+uniform sampler2D color_texture;
+uniform sampler2D normal_texture;
+uniform sampler2D specular_texture;
+uniform sampler2D atlas_texture;
+uniform sampler2D shadow_atlas_texture;
+
+uniform highp vec4 ninepatch_margins;
+uniform highp vec2 color_texture_pixel_size;
+uniform highp uint light_count;
+uniform mediump vec4 specular_shininess;
+
+layout(location = 0) out vec4 frag_color;
+
+#define LIGHT_FLAGS_BLEND_MASK (3u << 16u)
+#define LIGHT_FLAGS_BLEND_MODE_ADD (0u << 16u)
+#define LIGHT_FLAGS_BLEND_MODE_SUB (1u << 16u)
+#define LIGHT_FLAGS_BLEND_MODE_MIX (2u << 16u)
+#define LIGHT_FLAGS_BLEND_MODE_MASK (3u << 16u)
+#define LIGHT_FLAGS_HAS_SHADOW (1u << 20u)
+#define LIGHT_FLAGS_FILTER_SHIFT 22u
+#define LIGHT_FLAGS_FILTER_MASK (3u << 22u)
+#define SHADOW_TEST(m_uv) textureLod(shadow_atlas_texture, vec2(m_uv, shadow_uv.y), 0.0).x
+
+#ifdef USE_NINEPATCH
+float map_ninepatch_axis(float pixel, float draw_size, float tex_pixel_size, float margin_begin, float margin_end, int np_repeat, inout int draw_center) {
+	float tex_size = 1.0 / tex_pixel_size;
+	if (pixel < margin_begin) {
+		return pixel * tex_pixel_size;
+	} else if (pixel >= draw_size - margin_end) {
+		return (tex_size - (draw_size - pixel)) * tex_pixel_size;
+	} else {
+		draw_center -= 1 - int(step(0.5, float(np_repeat)));
+		float ofs = pixel - margin_begin;
+		float scale = (tex_size - margin_begin - margin_end) / (draw_size - margin_begin - margin_end);
+		if (np_repeat == 0) {
+			return (margin_begin + ofs * scale) * tex_pixel_size;
+		} else if (np_repeat == 1) {
+			return (margin_begin + mod(ofs, tex_size - margin_begin - margin_end)) * tex_pixel_size;
+		}
+		float repeat = mod(ofs, (tex_size - margin_begin - margin_end) * 2.0);
+		if (repeat > tex_size - margin_begin - margin_end) {
+			repeat = (tex_size - margin_begin - margin_end) * 2.0 - repeat;
+		}
+		return (margin_begin + repeat) * tex_pixel_size;
+	}
+}
+#endif
+
+vec3 light_normal_compute(vec3 light_vec, vec3 normal, vec3 base_color, vec3 light_color, vec4 specular_shininess_in, bool specular_shininess_used) {
+	float cNdotL = max(0.0, dot(normal, light_vec));
+	if (specular_shininess_used) {
+		vec3 view = vec3(0.0, 0.0, 1.0);
+		vec3 half_vec = normalize(view + light_vec);
+		float cNdotV = max(dot(normal, view), 0.0);
+		float cNdotH = max(dot(normal, half_vec), 0.0);
+		float cVdotH = max(dot(view, half_vec), 0.0);
+		float cLdotH = max(dot(light_vec, half_vec), 0.0);
+		float shininess = exp2(15.0 * specular_shininess_in.a + 1.0) * 0.25;
+		float blinn = pow(cNdotH, shininess);
+		blinn *= (shininess + 8.0) * (1.0 / (8.0 * 3.141592));
+		float s = (blinn) / max(4.0 * cNdotV * cNdotL, 0.75);
+		return specular_shininess_in.rgb * light_color * s * cNdotL + light_color * base_color * cNdotL * (1.0 - cLdotH * cVdotH * 0.0);
+	} else {
+		return light_color * base_color * cNdotL;
+	}
+}
+
+vec4 light_shadow_compute(uint light_base, vec4 light_color, vec4 shadow_uv) {
+	float shadow;
+	uint shadow_mode = light_array[light_base].flags & LIGHT_FLAGS_FILTER_MASK;
+
+	if (shadow_mode == (0u << LIGHT_FLAGS_FILTER_SHIFT)) {
+		shadow = SHADOW_TEST(shadow_uv.x);
+	} else if (shadow_mode == (1u << LIGHT_FLAGS_FILTER_SHIFT)) {
+		float ofs = light_array[light_base].shadow_pixel_size;
+		shadow = 0.0;
+		shadow += SHADOW_TEST(shadow_uv.x - ofs * 2.0);
+		shadow += SHADOW_TEST(shadow_uv.x - ofs);
+		shadow += SHADOW_TEST(shadow_uv.x);
+		shadow += SHADOW_TEST(shadow_uv.x + ofs);
+		shadow += SHADOW_TEST(shadow_uv.x + ofs * 2.0);
+		shadow /= 5.0;
+	} else {
+		float ofs = light_array[light_base].shadow_pixel_size;
+		shadow = 0.0;
+		for (int i = -6; i <= 6; i++) {
+			shadow += SHADOW_TEST(shadow_uv.x + ofs * float(i));
+		}
+		shadow /= 13.0;
+	}
+
+	uint packed_color = light_array[light_base].shadow_color;
+	vec4 shadow_color = vec4(uvec4(packed_color, packed_color >> 8u, packed_color >> 16u, packed_color >> 24u) & uvec4(0xFFu)) / 255.0;
+	return mix(light_color, shadow_color, shadow);
+}
+
+void light_blend_compute(uint light_base, vec4 light_color, inout vec3 color) {
+	uint blend_mode = light_array[light_base].flags & LIGHT_FLAGS_BLEND_MASK;
+
+	switch (blend_mode) {
+		case LIGHT_FLAGS_BLEND_MODE_ADD: {
+			color.rgb += light_color.rgb * light_color.a;
+		} break;
+		case LIGHT_FLAGS_BLEND_MODE_SUB: {
+			color.rgb -= light_color.rgb * light_color.a;
+		} break;
+		case LIGHT_FLAGS_BLEND_MODE_MIX: {
+			color.rgb = mix(color.rgb, light_color.rgb, light_color.a);
+		} break;
+		default:
+			break;
+	}
+}
+
+void main() {
+	vec4 color = color_interp;
+	vec2 uv = uv_interp;
+
+#ifdef USE_NINEPATCH
+	int draw_center = 2;
+	uv = vec2(
+			map_ninepatch_axis(vertex_interp.x, abs(ninepatch_margins.z), color_texture_pixel_size.x, ninepatch_margins.x, ninepatch_margins.y, 0, draw_center),
+			map_ninepatch_axis(vertex_interp.y, abs(ninepatch_margins.w), color_texture_pixel_size.y, ninepatch_margins.x, ninepatch_margins.y, 0, draw_center));
+	if (draw_center == 0) {
+		color.a = 0.0;
+	}
+#endif
+
+	color *= texture(color_texture, uv);
+
+	vec3 normal = texture(normal_texture, uv).rgb * 2.0 - 1.0;
+	normal.z = sqrt(max(0.0, 1.0 - dot(normal.xy, normal.xy)));
+	vec4 specular = texture(specular_texture, uv) * specular_shininess;
+
+#ifdef USE_LIGHTING
+	for (uint i = 0u; i < uint(MAX_LIGHTS); i++) {
+		if (i >= light_count) {
+			break;
+		}
+		if ((instance_light_mask & (1u << i)) == 0u) {
+			continue;
+		}
+		vec2 tex_uv = (vec4(vertex_interp, 0.0, 1.0) * mat4(light_array[i].texture_matrix[0], light_array[i].texture_matrix[1], vec4(0.0, 0.0, 1.0, 0.0), vec4(0.0, 0.0, 0.0, 1.0))).xy;
+		vec2 tex_uv_atlas = tex_uv * light_array[i].atlas_rect.zw + light_array[i].atlas_rect.xy;
+		vec4 light_color = textureLod(atlas_texture, tex_uv_atlas, 0.0) * light_array[i].color;
+
+		vec3 light_vec = normalize(vec3(light_array[i].position - vertex_interp, light_array[i].height));
+		light_color.rgb = light_normal_compute(light_vec, normal, color.rgb, light_color.rgb, specular, true);
+
+		if (bool(light_array[i].flags & LIGHT_FLAGS_HAS_SHADOW)) {
+			vec2 shadow_pos = (vec4(vertex_interp, 0.0, 1.0) * mat4(light_array[i].shadow_matrix[0], light_array[i].shadow_matrix[1], vec4(0.0, 0.0, 1.0, 0.0), vec4(0.0, 0.0, 0.0, 1.0))).xy;
+			vec4 shadow_uv = vec4(shadow_pos.x, light_array[i].shadow_y_ofs, 0.0, 1.0);
+			light_color = light_shadow_compute(i, light_color, shadow_uv);
+		}
+
+		light_blend_compute(i, light_color, color.rgb);
+	}
+#endif
+
+	frag_color = color;
+}
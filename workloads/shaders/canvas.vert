@@ -0,0 +1,104 @@
+#version 300 es
+
+#define MAX_LIGHTS 8
+#define USE_ATTRIBUTES
+#define USE_INSTANCING
+
+precision highp float;
+precision highp int;
+
+layout(location = 0) in vec2 vertex_attrib;
+#ifdef USE_ATTRIBUTES
+layout(location = 3) in vec4 color_attrib;
+layout(location = 4) in vec2 uv_attrib;
+#endif
+#ifdef USE_INSTANCING
+layout(location = 8) in vec4 instance_xform0;
+layout(location = 9) in vec4 instance_xform1;
+layout(location = 10) in vec4 instance_color;
+#endif
+
+layout(std140) uniform GlobalShaderUniformData {
+	vec4 global_shader_uniforms[16];
+};
+
+layout(std140) uniform CanvasData {
+	mat4 projection_matrix;
+	mat4 screen_transform;
+	mat4 canvas_transform;
+	mat4 canvas_normal_transform;
+	vec4 canvas_modulation;
+	vec2 screen_pixel_size;
+	float time;
+	bool use_pixel_snap;
+	vec4 sdf_to_tex;
+	vec2 screen_to_sdf;
+	vec2 sdf_to_screen;
+	uint directional_light_count;
+	float tex_to_sdf;
+	uint pad1;
+	uint pad2;
+};
+
+uniform highp mat2x4 world_transform;
+uniform highp vec4 modulation;
+uniform highp vec4 src_rect;
+uniform highp vec4 dst_rect;
+uniform highp uint flags;
+
+out vec2 uv_interp;
+out vec4 color_interp;
+out vec2 vertex_interp;
+flat out uint instance_light_mask;
+
+#define FLAGS_INSTANCING_HAS_COLORS (1u << 4u)
+#define FLAGS_USE_SKELETON (1u << 15u)
+#define FLAGS_FLIP_H (1u << 30u)
+#define FLAGS_FLIP_V (1u << 31u)
+
+vec2 snap_vertex(vec2 v) {
+	return floor(v + 0.5);
+}
+
+void main() {
+	vec4 instance_custom = vec4(0.0);
+#ifdef USE_ATTRIBUTES
+	vec2 uv = uv_attrib;
+	vec4 color = color_attrib * modulation;
+#else
+	vec2 uv = vertex_attrib * src_rect.zw + src_rect.xy;
+	vec4 color = modulation;
+#endif
+	vec2 vertex = vertex_attrib;
+
+	if (bool(flags & FLAGS_FLIP_H)) {
+		uv.x = 1.0 - uv.x;
+	}
+	if (bool(flags & FLAGS_FLIP_V)) {
+		uv.y = 1.0 - uv.y;
+	}
+
+	mat4 model_matrix = mat4(vec4(world_transform[0].xy, 0.0, 0.0), vec4(world_transform[0].zw, 0.0, 0.0), vec4(0.0, 0.0, 1.0, 0.0), vec4(world_transform[1].xy, 0.0, 1.0));
+
+#ifdef USE_INSTANCING
+	if (bool(flags & FLAGS_INSTANCING_HAS_COLORS)) {
+		color *= instance_color;
+	}
+	mat4 instance_matrix = mat4(vec4(instance_xform0.xy, 0.0, 0.0), vec4(instance_xform1.xy, 0.0, 0.0), vec4(0.0, 0.0, 1.0, 0.0), vec4(instance_xform0.w, instance_xform1.w, 0.0, 1.0));
+	model_matrix = model_matrix * instance_matrix;
+#endif
+
+	vec4 world = model_matrix * vec4(vertex, 0.0, 1.0);
+	world.xy += global_shader_uniforms[0].xy * sin(time);
+	vertex = (canvas_transform * world).xy;
+	vertex_interp = vertex;
+
+	if (use_pixel_snap) {
+		vertex = snap_vertex(vertex);
+	}
+
+	uv_interp = uv;
+	color_interp = color * canvas_modulation;
+	instance_light_mask = flags & 0xFFu;
+	gl_Position = projection_matrix * screen_transform * vec4(vertex, 0.0, 1.0);
+}
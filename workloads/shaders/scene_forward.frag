@@ -0,0 +1,303 @@
+#version 300 es
+
+#define USE_TANGENT
+#define USE_SHADOWS
+#define USE_FOG
+#define USE_RADIANCE_MAP
+#define MAX_DIRECTIONAL_LIGHTS 4
+#define MAX_FORWARD_LIGHTS 8
+#define SHADOW_SAMPLES 5
+#define M_PI 3.14159265359
+#define EPSILON 0.0001
+
+precision highp float;
+precision highp int;
+precision highp sampler2DShadow;
+
+in highp vec3 vertex_interp;
+in vec3 normal_interp;
+in vec4 color_interp;
+in vec2 uv_interp;
+in vec2 uv2_interp;
+#ifdef USE_TANGENT
+in vec3 tangent_interp;
+in vec3 binormal_interp;
+#endif
+
+layout(std140) uniform SceneData {
+	highp mat4 projection_matrix;
+	highp mat4 inv_projection_matrix;
+	highp mat4 inv_view_matrix;
+	highp mat4 view_matrix;
+	vec2 viewport_size;
+	vec2 screen_pixel_size;
+	mediump vec4 ambient_light_color_energy;
+	mediump float ambient_color_sky_mix;
+	float emissive_exposure_normalization;
+	bool use_ambient_light;
+	bool use_ambient_cubemap;
+	bool use_reflection_cubemap;
+	float fog_aerial_perspective;
+	float time;
+	mediump mat3 radiance_inverse_xform;
+	uint directional_light_count;
+	float z_far;
+	float z_near;
+	float IBL_exposure_normalization;
+	bool fog_enabled;
+	uint fog_mode;
+	float fog_density;
+	float fog_height;
+	float fog_height_density;
+	float fog_depth_curve;
+	float fog_sun_scatter;
+	float fog_depth_begin;
+	vec3 fog_light_color;
+	float fog_depth_end;
+	float shadow_bias;
+	float luminance_multiplier;
+	uint camera_visible_layers;
+	bool pancake_shadows;
+}
+scene_data;
+
+struct DirectionalLightData {
+	mediump vec3 direction;
+	mediump float energy;
+	mediump vec3 color;
+	mediump float size;
+	mediump vec2 pad;
+	mediump float shadow_opacity;
+	mediump float specular;
+	highp mat4 shadow_matrix;
+};
+
+struct LightData {
+	highp vec3 position;
+	highp float inv_radius;
+	mediump vec3 direction;
+	highp float attenuation;
+	mediump vec3 color;
+	mediump float energy;
+	mediump float cone_attenuation;
+	mediump float cone_angle;
+	mediump float specular_amount;
+	mediump float shadow_opacity;
+};
+
+layout(std140) uniform DirectionalLights {
+	DirectionalLightData directional_lights[MAX_DIRECTIONAL_LIGHTS];
+};
+
+layout(std140) uniform OmniLightData {
+	LightData omni_lights[MAX_FORWARD_LIGHTS];
+};
+
+layout(std140) uniform SpotLightData {
+	LightData spot_lights[MAX_FORWARD_LIGHTS];
+};
+
+uniform sampler2D albedo_texture;
+uniform sampler2D normal_texture;
+uniform sampler2D orm_texture;
+uniform sampler2D emission_texture;
+uniform samplerCube radiance_map;
+uniform highp sampler2DShadow directional_shadow_atlas;
+
+uniform mediump vec4 albedo_color;
+uniform mediump float roughness_scale;
+uniform mediump float metallic_scale;
+uniform mediump float normal_scale;
+uniform mediump vec3 emission_color;
+uniform int omni_light_count;
+uniform int spot_light_count;
+uniform lowp float radiance_max_lod;
+
+layout(location = 0) out vec4 frag_color;
+
+float D_GGX(float cos_theta_m, float alpha) {
+	float a = cos_theta_m * alpha;
+	float k = alpha / (1.0 - cos_theta_m * cos_theta_m + a * a);
+	return k * k * (1.0 / M_PI);
+}
+
+float V_GGX(float NdotL, float NdotV, float alpha) {
+	return 0.5 / mix(2.0 * NdotL * NdotV, NdotL + NdotV, alpha);
+}
+
+float SchlickFresnel(float u) {
+	float m = 1.0 - u;
+	float m2 = m * m;
+	return m2 * m2 * m;
+}
+
+vec3 F0(float metallic, float specular, vec3 albedo) {
+	float dielectric = 0.16 * specular * specular;
+	return mix(vec3(dielectric), albedo, vec3(metallic));
+}
+
+void light_compute(vec3 N, vec3 L, vec3 V, float A, vec3 light_color, float attenuation, vec3 f0, float roughness, float metallic, float specular_amount, vec3 albedo, inout float alpha, inout vec3 diffuse_light, inout vec3 specular_light) {
+	float NdotL = min(A + dot(N, L), 1.0);
+	float cNdotL = max(NdotL, 0.0);
+	float cNdotV = max(dot(N, V), 1e-4);
+
+	if (metallic < 1.0) {
+		float diffuse_brdf_NL = cNdotL * (1.0 / M_PI);
+		diffuse_light += light_color * diffuse_brdf_NL * attenuation;
+	}
+
+	if (roughness > 0.0) {
+		vec3 H = normalize(V + L);
+		float cLdotH = clamp(A + dot(L, H), 0.0, 1.0);
+		float cNdotH = clamp(A + dot(N, H), 0.0, 1.0);
+		float alpha_ggx = roughness * roughness;
+		float D = D_GGX(cNdotH, alpha_ggx);
+		float G = V_GGX(cNdotL, cNdotV, alpha_ggx);
+		float cLdotH5 = SchlickFresnel(cLdotH);
+		float f90 = clamp(dot(f0, vec3(50.0 * 0.33)), metallic, 1.0);
+		vec3 F = f0 + (f90 - f0) * cLdotH5;
+		vec3 specular_brdf_NL = cNdotL * D * F * G;
+		specular_light += specular_brdf_NL * light_color * attenuation * specular_amount;
+	}
+}
+
+float get_omni_attenuation(float distance, float inv_range, float decay) {
+	float nd = distance * inv_range;
+	nd *= nd;
+	nd *= nd;
+	nd = max(1.0 - nd, 0.0);
+	nd *= nd;
+	return nd * pow(max(distance, 0.0001), -decay);
+}
+
+#ifdef USE_SHADOWS
+float sample_shadow(highp sampler2DShadow shadow, highp vec4 pos) {
+	float avg = 0.0;
+	highp vec2 pixel_size = 1.0 / vec2(textureSize(shadow, 0));
+	for (int i = 0; i < SHADOW_SAMPLES; i++) {
+		for (int j = 0; j < SHADOW_SAMPLES; j++) {
+			highp vec2 ofs = vec2(float(i - SHADOW_SAMPLES / 2), float(j - SHADOW_SAMPLES / 2)) * pixel_size;
+			avg += texture(shadow, vec3(pos.xy + ofs, pos.z));
+		}
+	}
+	return avg * (1.0 / float(SHADOW_SAMPLES * SHADOW_SAMPLES));
+}
+#endif
+
+#ifdef USE_FOG
+vec4 fog_process(vec3 vertex) {
+	vec3 fog_color = scene_data.fog_light_color;
+	float fog_amount = 0.0;
+	if (scene_data.fog_mode == 0u) {
+		fog_amount = 1.0 - exp(min(0.0, -length(vertex) * scene_data.fog_density));
+	} else {
+		float fog_z = smoothstep(scene_data.fog_depth_begin, scene_data.fog_depth_end, length(vertex));
+		fog_amount = pow(fog_z, scene_data.fog_depth_curve) * scene_data.fog_density;
+	}
+	if (abs(scene_data.fog_height_density) >= 0.0001) {
+		float y = (scene_data.inv_view_matrix * vec4(vertex, 1.0)).y;
+		float y_dist = y - scene_data.fog_height;
+		float vfog_amount = 1.0 - exp(min(0.0, y_dist * scene_data.fog_height_density));
+		fog_amount = max(vfog_amount, fog_amount);
+	}
+	return vec4(fog_color, fog_amount);
+}
+#endif
+
+void main() {
+	vec3 vertex = vertex_interp;
+	vec3 view = -normalize(vertex_interp);
+	vec4 albedo_tex = texture(albedo_texture, uv_interp);
+	vec3 albedo = albedo_color.rgb * albedo_tex.rgb * color_interp.rgb;
+	float alpha = albedo_color.a * albedo_tex.a;
+	vec4 orm = texture(orm_texture, uv_interp);
+	float ao = orm.r;
+	float roughness = clamp(orm.g * roughness_scale, 0.0, 1.0);
+	float metallic = clamp(orm.b * metallic_scale, 0.0, 1.0);
+	float specular = 0.5;
+	vec3 emission = texture(emission_texture, uv2_interp).rgb * emission_color;
+
+	vec3 normal = normalize(normal_interp);
+	if (!gl_FrontFacing) {
+		normal = -normal;
+	}
+#ifdef USE_TANGENT
+	vec3 tangent = normalize(tangent_interp);
+	vec3 binormal = normalize(binormal_interp);
+	vec3 normal_map = texture(normal_texture, uv_interp).rgb * 2.0 - 1.0;
+	normal_map.z = sqrt(max(0.0, 1.0 - dot(normal_map.xy, normal_map.xy)));
+	normal = normalize(mix(normal, tangent * normal_map.x + binormal * normal_map.y + normal * normal_map.z, normal_scale));
+#endif
+
+	vec3 f0 = F0(metallic, specular, albedo);
+	vec3 diffuse_light = vec3(0.0);
+	vec3 specular_light = vec3(0.0);
+	vec3 ambient_light = vec3(0.0);
+
+#ifdef USE_RADIANCE_MAP
+	if (scene_data.use_reflection_cubemap) {
+		vec3 ref_vec = reflect(-view, normal);
+		ref_vec = scene_data.radiance_inverse_xform * ref_vec;
+		float horizon = min(1.0 + dot(ref_vec, normal), 1.0);
+		specular_light = textureLod(radiance_map, ref_vec, sqrt(roughness) * radiance_max_lod).rgb;
+		specular_light *= horizon * horizon * scene_data.IBL_exposure_normalization;
+	}
+	if (scene_data.use_ambient_cubemap) {
+		vec3 ambient_dir = scene_data.radiance_inverse_xform * normal;
+		ambient_light = textureLod(radiance_map, ambient_dir, radiance_max_lod).rgb;
+	}
+#endif
+	if (scene_data.use_ambient_light) {
+		ambient_light = mix(scene_data.ambient_light_color_energy.rgb, ambient_light, scene_data.ambient_color_sky_mix);
+	}
+
+	for (uint i = 0u; i < uint(MAX_DIRECTIONAL_LIGHTS); i++) {
+		if (i >= scene_data.directional_light_count) {
+			break;
+		}
+		float shadow = 1.0;
+#ifdef USE_SHADOWS
+		if (directional_lights[i].shadow_opacity > 0.001) {
+			highp vec4 shadow_coord = directional_lights[i].shadow_matrix * vec4(vertex + normal * scene_data.shadow_bias, 1.0);
+			shadow_coord.xyz /= shadow_coord.w;
+			shadow = mix(1.0, sample_shadow(directional_shadow_atlas, shadow_coord), directional_lights[i].shadow_opacity);
+		}
+#endif
+		light_compute(normal, normalize(directional_lights[i].direction), view, directional_lights[i].size, directional_lights[i].color * directional_lights[i].energy, shadow, f0, roughness, metallic, directional_lights[i].specular, albedo, alpha, diffuse_light, specular_light);
+	}
+
+	for (int i = 0; i < MAX_FORWARD_LIGHTS; i++) {
+		if (i >= omni_light_count) {
+			break;
+		}
+		vec3 light_rel_vec = omni_lights[i].position - vertex;
+		float light_length = length(light_rel_vec);
+		float omni_attenuation = get_omni_attenuation(light_length, omni_lights[i].inv_radius, omni_lights[i].attenuation);
+		light_compute(normal, normalize(light_rel_vec), view, 0.0, omni_lights[i].color * omni_lights[i].energy, omni_attenuation, f0, roughness, metallic, omni_lights[i].specular_amount, albedo, alpha, diffuse_light, specular_light);
+	}
+
+	for (int i = 0; i < MAX_FORWARD_LIGHTS; i++) {
+		if (i >= spot_light_count) {
+			break;
+		}
+		vec3 light_rel_vec = spot_lights[i].position - vertex;
+		float light_length = length(light_rel_vec);
+		float spot_attenuation = get_omni_attenuation(light_length, spot_lights[i].inv_radius, spot_lights[i].attenuation);
+		vec3 spot_dir = spot_lights[i].direction;
+		float scos = max(dot(-normalize(light_rel_vec), spot_dir), spot_lights[i].cone_angle);
+		float spot_rim = max(0.0001, (1.0 - scos) / (1.0 - spot_lights[i].cone_angle));
+		spot_attenuation *= 1.0 - pow(spot_rim, spot_lights[i].cone_attenuation);
+		light_compute(normal, normalize(light_rel_vec), view, 0.0, spot_lights[i].color * spot_lights[i].energy, spot_attenuation, f0, roughness, metallic, spot_lights[i].specular_amount, albedo, alpha, diffuse_light, specular_light);
+	}
+
+	vec3 color = (diffuse_light + ambient_light * ao) * albedo * (1.0 - metallic) + specular_light * f0 + emission * scene_data.emissive_exposure_normalization;
+
+#ifdef USE_FOG
+	if (scene_data.fog_enabled) {
+		vec4 fog = fog_process(vertex);
+		color = mix(color, fog.rgb, fog.a);
+	}
+#endif
+
+	frag_color = vec4(color * scene_data.luminance_multiplier, alpha);
+}
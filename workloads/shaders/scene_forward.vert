@@ -0,0 +1,131 @@
+#version 300 es
+
+#define USE_SKELETON
+#define USE_TANGENT
+#define USE_MULTIVIEW_DISABLED
+#define MAX_BONES 64
+
+precision highp float;
+precision highp int;
+
+layout(location = 0) in highp vec3 vertex_attrib;
+layout(location = 1) in vec3 normal_attrib;
+#ifdef USE_TANGENT
+layout(location = 2) in vec4 tangent_attrib;
+#endif
+layout(location = 3) in vec4 color_attrib;
+layout(location = 4) in vec2 uv_attrib;
+layout(location = 5) in vec2 uv2_attrib;
+#ifdef USE_SKELETON
+layout(location = 10) in uvec4 bone_attrib;
+layout(location = 11) in vec4 weight_attrib;
+#endif
+
+layout(std140) uniform SceneData {
+	highp mat4 projection_matrix;
+	highp mat4 inv_projection_matrix;
+	highp mat4 inv_view_matrix;
+	highp mat4 view_matrix;
+	vec2 viewport_size;
+	vec2 screen_pixel_size;
+	mediump vec4 ambient_light_color_energy;
+	mediump float ambient_color_sky_mix;
+	float emissive_exposure_normalization;
+	bool use_ambient_light;
+	bool use_ambient_cubemap;
+	bool use_reflection_cubemap;
+	float fog_aerial_perspective;
+	float time;
+	mediump mat3 radiance_inverse_xform;
+	uint directional_light_count;
+	float z_far;
+	float z_near;
+	float IBL_exposure_normalization;
+	bool fog_enabled;
+	uint fog_mode;
+	float fog_density;
+	float fog_height;
+	float fog_height_density;
+	float fog_depth_curve;
+	float fog_sun_scatter;
+	float fog_depth_begin;
+	vec3 fog_light_color;
+	float fog_depth_end;
+	float shadow_bias;
+	float luminance_multiplier;
+	uint camera_visible_layers;
+	bool pancake_shadows;
+}
+scene_data;
+
+#ifdef USE_SKELETON
+layout(std140) uniform SkeletonData {
+	highp mat4 bones[MAX_BONES];
+};
+#endif
+
+uniform highp mat4 world_transform;
+uniform highp vec4 uv_scale;
+uniform highp uint model_flags;
+
+out highp vec3 vertex_interp;
+out vec3 normal_interp;
+out vec4 color_interp;
+out vec2 uv_interp;
+out vec2 uv2_interp;
+#ifdef USE_TANGENT
+out vec3 tangent_interp;
+out vec3 binormal_interp;
+#endif
+
+#define FLAGS_NON_UNIFORM_SCALE (1u << 4u)
+
+void main() {
+	highp vec3 vertex = vertex_attrib;
+	vec3 normal = normal_attrib * 2.0 - 1.0;
+#ifdef USE_TANGENT
+	vec3 tangent = tangent_attrib.xyz * 2.0 - 1.0;
+	float binormalf = tangent_attrib.w;
+	vec3 binormal = normalize(cross(normal, tangent) * binormalf);
+#endif
+
+#ifdef USE_SKELETON
+	highp mat4 skin = bones[int(bone_attrib.x)] * weight_attrib.x;
+	skin += bones[int(bone_attrib.y)] * weight_attrib.y;
+	skin += bones[int(bone_attrib.z)] * weight_attrib.z;
+	skin += bones[int(bone_attrib.w)] * weight_attrib.w;
+
+	vertex = (skin * vec4(vertex, 1.0)).xyz;
+	normal = normalize((skin * vec4(normal, 0.0)).xyz);
+#ifdef USE_TANGENT
+	tangent = normalize((skin * vec4(tangent, 0.0)).xyz);
+	binormal = normalize((skin * vec4(binormal, 0.0)).xyz);
+#endif
+#endif
+
+	highp mat4 model_matrix = world_transform;
+	mat3 model_normal_matrix = mat3(model_matrix);
+	if (bool(model_flags & FLAGS_NON_UNIFORM_SCALE)) {
+		model_normal_matrix = transpose(inverse(model_normal_matrix));
+	}
+
+	color_interp = color_attrib;
+	uv_interp = uv_attrib * uv_scale.xy;
+	uv2_interp = uv2_attrib * uv_scale.zw;
+
+	highp mat4 modelview = scene_data.view_matrix * model_matrix;
+	mat3 modelview_normal = mat3(scene_data.view_matrix) * model_normal_matrix;
+
+	vertex = (modelview * vec4(vertex, 1.0)).xyz;
+	normal = normalize(modelview_normal * normal);
+#ifdef USE_TANGENT
+	binormal = normalize(modelview_normal * binormal);
+	tangent = normalize(modelview_normal * tangent);
+	tangent_interp = tangent;
+	binormal_interp = binormal;
+#endif
+
+	vertex_interp = vertex;
+	normal_interp = normal;
+	gl_Position = scene_data.projection_matrix * vec4(vertex_interp, 1.0);
+}
@@ -0,0 +1,117 @@
+#version 300 es
+
+#define USE_CUBEMAP_PASS_DISABLED
+#define MAX_DIRECTIONAL_LIGHT_DATA_STRUCTS 4
+#define M_PI 3.14159265359
+
+precision highp float;
+precision highp int;
+
+in vec2 uv_interp;
+
+struct DirectionalLightData {
+	vec4 direction_energy;
+	vec4 color_size;
+	bool enabled;
+};
+
+layout(std140) uniform DirectionalLights {
+	DirectionalLightData data[MAX_DIRECTIONAL_LIGHT_DATA_STRUCTS];
+}
+directional_lights;
+
+layout(std140) uniform MaterialUniforms {
+	vec4 rayleigh_color;
+	vec4 mie_color;
+	vec4 ground_color;
+	float rayleigh;
+	float mie;
+	float mie_eccentricity;
+	float turbidity;
+	float sun_disk_scale;
+	float exposure;
+};
+
+uniform mat3 orientation;
+uniform vec4 projection;
+uniform vec3 position;
+uniform float time;
+uniform float sky_energy_multiplier;
+uniform float luminance_multiplier;
+uniform uint directional_light_count;
+uniform sampler2D night_sky;
+
+layout(location = 0) out vec4 frag_color;
+
+const float rayleigh_zenith_size = 8.4e3;
+const float mie_zenith_size = 1.25e3;
+
+float henyey_greenstein(float cos_theta, float g) {
+	const float k = 0.0795774715459;
+	return k * (1.0 - g * g) / (pow(1.0 + g * g - 2.0 * g * cos_theta, 1.5));
+}
+
+vec3 sky(vec3 eyedir, vec3 light_dir, vec3 light_color, float light_size, float light_energy) {
+	float zenith_angle = clamp(dot(vec3(0.0, 1.0, 0.0), normalize(light_dir)), -1.0, 1.0);
+	float sun_energy = max(0.0, 1.0 - exp(-((M_PI * 0.5) - acos(zenith_angle)))) * light_energy;
+	float sun_fade = 1.0 - clamp(1.0 - exp(light_dir.y), 0.0, 1.0);
+
+	float rayleigh_coefficient = rayleigh - (1.0 * (1.0 - sun_fade));
+	vec3 rayleigh_beta = rayleigh_coefficient * rayleigh_color.rgb * 0.0001;
+	vec3 mie_beta = turbidity * mie * mie_color.rgb * 0.000434;
+
+	float zenith = acos(max(0.0, dot(vec3(0.0, 1.0, 0.0), eyedir)));
+	float optical_mass = 1.0 / (cos(zenith) + 0.15 * pow(93.885 - degrees(zenith), -1.253));
+	float rayleigh_scatter = rayleigh_zenith_size * optical_mass;
+	float mie_scatter = mie_zenith_size * optical_mass;
+
+	vec3 extinction = exp(-(rayleigh_beta * rayleigh_scatter + mie_beta * mie_scatter));
+
+	float cos_theta = dot(eyedir, normalize(light_dir));
+	float rayleigh_phase = (3.0 / (16.0 * M_PI)) * (1.0 + pow(cos_theta * 0.5 + 0.5, 2.0));
+	vec3 betaRTheta = rayleigh_beta * rayleigh_phase;
+	float mie_phase = henyey_greenstein(cos_theta, mie_eccentricity);
+	vec3 betaMTheta = mie_beta * mie_phase;
+
+	vec3 Lin = pow(sun_energy * ((betaRTheta + betaMTheta) / (rayleigh_beta + mie_beta)) * (1.0 - extinction), vec3(1.5));
+	Lin *= mix(vec3(1.0), pow(sun_energy * ((betaRTheta + betaMTheta) / (rayleigh_beta + mie_beta)) * extinction, vec3(0.5)), clamp(pow(1.0 - zenith_angle, 5.0), 0.0, 1.0));
+
+	vec3 L0 = 0.1 * extinction;
+	float sunAngularDiameterCos = cos(light_size * sun_disk_scale);
+	float sunAngularDiameterCos2 = cos(light_size * sun_disk_scale * 0.5);
+	float sundisk = smoothstep(sunAngularDiameterCos, sunAngularDiameterCos2, cos_theta);
+	L0 += (sun_energy * extinction) * sundisk * light_color;
+
+	return (Lin + L0) * 0.04;
+}
+
+void main() {
+	vec3 cube_normal;
+	cube_normal.z = -1.0;
+	cube_normal.x = (cube_normal.z * (-uv_interp.x - projection.x)) / projection.y;
+	cube_normal.y = -(cube_normal.z * (-uv_interp.y - projection.z)) / projection.w;
+	cube_normal = mat3(orientation) * cube_normal;
+	cube_normal = normalize(cube_normal);
+
+	vec2 uv = vec2(atan(cube_normal.x, cube_normal.z), acos(cube_normal.y));
+	uv = uv * vec2(0.5 / M_PI, 1.0 / M_PI) + vec2(0.5, 0.0);
+
+	vec3 color = vec3(0.0);
+	for (uint i = 0u; i < uint(MAX_DIRECTIONAL_LIGHT_DATA_STRUCTS); i++) {
+		if (i >= directional_light_count) {
+			break;
+		}
+		if (!directional_lights.data[i].enabled) {
+			continue;
+		}
+		color += sky(cube_normal, directional_lights.data[i].direction_energy.xyz, directional_lights.data[i].color_size.rgb, directional_lights.data[i].color_size.a, directional_lights.data[i].direction_energy.a);
+	}
+
+	if (cube_normal.y < 0.0) {
+		color = mix(color, ground_color.rgb, smoothstep(0.0, -0.05, cube_normal.y));
+	} else {
+		color += texture(night_sky, uv).rgb * (1.0 - clamp(length(color) * 4.0, 0.0, 1.0));
+	}
+
+	frag_color = vec4(color * exposure * sky_energy_multiplier * luminance_multiplier, 1.0);
+}
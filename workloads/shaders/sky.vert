@@ -0,0 +1,12 @@
+#version 300 es
+
+precision highp float;
+
+layout(location = 0) in vec2 vertex_attrib;
+
+out vec2 uv_interp;
+
+void main() {
+	uv_interp = vertex_attrib;
+	gl_Position = vec4(uv_interp, 1.0, 1.0);
+}
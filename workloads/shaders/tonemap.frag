@@ -0,0 +1,181 @@
+#version 300 es
+
+#define USE_GLOW
+#define USE_BCS
+#define USE_COLOR_CORRECTION
+#define TONEMAPPER_LINEAR 0
+#define TONEMAPPER_REINHARD 1
+#define TONEMAPPER_FILMIC 2
+#define TONEMAPPER_ACES 3
+#define GLOW_MODE_ADD 0
+#define GLOW_MODE_SCREEN 1
+#define GLOW_MODE_SOFTLIGHT 2
+#define GLOW_MODE_REPLACE 3
+#define GLOW_MODE_MIX 4
+#define GLOW_LEVELS 7
+
+precision highp float;
+precision highp int;
+
+in vec2 uv_interp;
+
+uniform sampler2D source_color;
+#ifdef USE_GLOW
+uniform sampler2D glow_color;
+uniform vec2 pixel_size;
+uniform float glow_intensity;
+uniform float glow_levels[GLOW_LEVELS];
+uniform int glow_mode;
+#endif
+#ifdef USE_BCS
+uniform vec3 bcs;
+#endif
+#ifdef USE_COLOR_CORRECTION
+uniform sampler2D color_correction;
+#endif
+uniform float exposure;
+uniform float white;
+uniform int tonemapper;
+
+layout(location = 0) out vec4 frag_color;
+
+vec3 tonemap_filmic(vec3 color, float p_white) {
+	const float exposure_bias = 2.0;
+	const float A = 0.22 * exposure_bias * exposure_bias;
+	const float B = 0.30 * exposure_bias;
+	const float C = 0.10;
+	const float D = 0.20;
+	const float E = 0.01;
+	const float F = 0.30;
+
+	vec3 color_tonemapped = ((color * (A * color + C * B) + D * E) / (color * (A * color + B) + D * F)) - E / F;
+	float p_white_tonemapped = ((p_white * (A * p_white + C * B) + D * E) / (p_white * (A * p_white + B) + D * F)) - E / F;
+
+	return color_tonemapped / p_white_tonemapped;
+}
+
+vec3 tonemap_aces(vec3 color, float p_white) {
+	const float exposure_bias = 1.8;
+	const float A = 0.0245786;
+	const float B = 0.000090537;
+	const float C = 0.983729;
+	const float D = 0.432951;
+	const float E = 0.238081;
+
+	const mat3 rgb_to_rrt = mat3(
+			vec3(0.59719 * exposure_bias, 0.35458 * exposure_bias, 0.04823 * exposure_bias),
+			vec3(0.07600 * exposure_bias, 0.90834 * exposure_bias, 0.01566 * exposure_bias),
+			vec3(0.02840 * exposure_bias, 0.13383 * exposure_bias, 0.83777 * exposure_bias));
+
+	const mat3 odt_to_rgb = mat3(
+			vec3(1.60475, -0.53108, -0.07367),
+			vec3(-0.10208, 1.10813, -0.00605),
+			vec3(-0.00327, -0.07276, 1.07602));
+
+	color *= rgb_to_rrt;
+	vec3 color_tonemapped = (color * (color + A) - B) / (color * (C * color + D) + E);
+	color_tonemapped *= odt_to_rgb;
+
+	p_white *= exposure_bias;
+	float p_white_tonemapped = (p_white * (p_white + A) - B) / (p_white * (C * p_white + D) + E);
+
+	return color_tonemapped / p_white_tonemapped;
+}
+
+vec3 tonemap_reinhard(vec3 color, float p_white) {
+	return (p_white * color + color) / (color * p_white + p_white);
+}
+
+vec3 linear_to_srgb(vec3 color) {
+	const vec3 a = vec3(0.055);
+	return mix((vec3(1.0) + a) * pow(color.rgb, vec3(1.0 / 2.4)) - a, 12.92 * color.rgb, lessThan(color.rgb, vec3(0.0031308)));
+}
+
+vec3 apply_tonemapping(vec3 color, float p_white) {
+	if (tonemapper == TONEMAPPER_LINEAR) {
+		return color;
+	} else if (tonemapper == TONEMAPPER_REINHARD) {
+		return tonemap_reinhard(max(vec3(0.0), color), p_white);
+	} else if (tonemapper == TONEMAPPER_FILMIC) {
+		return tonemap_filmic(max(vec3(0.0), color), p_white);
+	} else {
+		return tonemap_aces(max(vec3(0.0), color), p_white);
+	}
+}
+
+#ifdef USE_GLOW
+vec3 gather_glow() {
+	vec3 glow = vec3(0.0);
+	for (int i = 0; i < GLOW_LEVELS; i++) {
+		if (glow_levels[i] > 0.0) {
+			glow += textureLod(glow_color, uv_interp, float(i)).rgb * glow_levels[i];
+		}
+	}
+	return glow;
+}
+
+vec3 apply_glow(vec3 color, vec3 glow) {
+	if (glow_mode == GLOW_MODE_ADD) {
+		return color + glow;
+	} else if (glow_mode == GLOW_MODE_SCREEN) {
+		return max((color + glow) - (color * glow), vec3(0.0));
+	} else if (glow_mode == GLOW_MODE_SOFTLIGHT) {
+		glow = glow * vec3(0.5) + vec3(0.5);
+		color.r = (glow.r <= 0.5) ? (color.r - (1.0 - 2.0 * glow.r) * color.r * (1.0 - color.r)) : (((glow.r > 0.5) && (color.r <= 0.25)) ? (color.r + (2.0 * glow.r - 1.0) * (4.0 * color.r * (4.0 * color.r + 1.0) * (color.r - 1.0) + 7.0 * color.r)) : (color.r + (2.0 * glow.r - 1.0) * (sqrt(color.r) - color.r)));
+		color.g = (glow.g <= 0.5) ? (color.g - (1.0 - 2.0 * glow.g) * color.g * (1.0 - color.g)) : (((glow.g > 0.5) && (color.g <= 0.25)) ? (color.g + (2.0 * glow.g - 1.0) * (4.0 * color.g * (4.0 * color.g + 1.0) * (color.g - 1.0) + 7.0 * color.g)) : (color.g + (2.0 * glow.g - 1.0) * (sqrt(color.g) - color.g)));
+		color.b = (glow.b <= 0.5) ? (color.b - (1.0 - 2.0 * glow.b) * color.b * (1.0 - color.b)) : (((glow.b > 0.5) && (color.b <= 0.25)) ? (color.b + (2.0 * glow.b - 1.0) * (4.0 * color.b * (4.0 * color.b + 1.0) * (color.b - 1.0) + 7.0 * color.b)) : (color.b + (2.0 * glow.b - 1.0) * (sqrt(color.b) - color.b)));
+		return color;
+	} else if (glow_mode == GLOW_MODE_REPLACE) {
+		return glow;
+	} else {
+		return mix(color, glow, glow_intensity);
+	}
+}
+#endif
+
+#ifdef USE_BCS
+vec3 apply_bcs(vec3 color) {
+	color = mix(vec3(0.0), color, bcs.x);
+	color = mix(vec3(0.5), color, bcs.y);
+	color = mix(vec3(dot(vec3(1.0), color) * 0.33333), color, bcs.z);
+	return color;
+}
+#endif
+
+#ifdef USE_COLOR_CORRECTION
+vec3 apply_color_correction(vec3 color) {
+	color.r = texture(color_correction, vec2(color.r, 0.0)).r;
+	color.g = texture(color_correction, vec2(color.g, 0.0)).g;
+	color.b = texture(color_correction, vec2(color.b, 0.0)).b;
+	return color;
+}
+#endif
+
+void main() {
+	vec4 color = textureLod(source_color, uv_interp, 0.0);
+	color.rgb *= exposure;
+
+#ifdef USE_GLOW
+	vec3 glow = gather_glow() * glow_intensity;
+	if (glow_mode != GLOW_MODE_MIX) {
+		glow = apply_tonemapping(glow, white);
+	}
+#endif
+
+	color.rgb = apply_tonemapping(color.rgb, white);
+	color.rgb = linear_to_srgb(color.rgb);
+
+#ifdef USE_GLOW
+	color.rgb = apply_glow(color.rgb, linear_to_srgb(glow));
+#endif
+
+#ifdef USE_BCS
+	color.rgb = apply_bcs(color.rgb);
+#endif
+
+#ifdef USE_COLOR_CORRECTION
+	color.rgb = apply_color_correction(color.rgb);
+#endif
+
+	frag_color = color;
+}
@@ -0,0 +1,334 @@
+//
+// Shared helpers for the workload drivers built by `scons pgo_train` and `scons bench`.
+// They only use ANGLE's public EGL, GLES and translator entry points, so the drivers link
+// against the same static archives Godot does.
+//
+
+#ifndef WORKLOADS_WORKLOAD_UTILS_H_
+#define WORKLOADS_WORKLOAD_UTILS_H_
+
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include <EGL/eglext_angle.h>
+#include <GLES3/gl3.h>
+#include <GLSLANG/ShaderLang.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace workloads
+{
+
+struct ShaderSource
+{
+    std::string name;
+    GLenum type;
+    std::string source;
+};
+
+struct ShaderProgramSource
+{
+    std::string name;
+    const ShaderSource *vertex;
+    const ShaderSource *fragment;
+};
+
+// Loads every `.vert` and `.frag` file of the corpus directory, sorted by name so that runs
+// are reproducible.
+inline std::vector<ShaderSource> LoadShaderCorpus(const std::string &directory)
+{
+    std::vector<ShaderSource> corpus;
+    std::error_code error;
+    for (const auto &entry : std::filesystem::directory_iterator(directory, error))
+    {
+        const std::filesystem::path &path = entry.path();
+        GLenum type                       = 0;
+        if (path.extension() == ".vert")
+        {
+            type = GL_VERTEX_SHADER;
+        }
+        else if (path.extension() == ".frag")
+        {
+            type = GL_FRAGMENT_SHADER;
+        }
+        else
+        {
+            continue;
+        }
+
+        std::ifstream file(path, std::ios::binary);
+        std::stringstream contents;
+        contents << file.rdbuf();
+        corpus.push_back({path.filename().string(), type, contents.str()});
+    }
+
+    if (error)
+    {
+        fprintf(stderr, "Could not read shader corpus %s: %s\n", directory.c_str(),
+                error.message().c_str());
+    }
+
+    std::sort(corpus.begin(), corpus.end(),
+              [](const ShaderSource &a, const ShaderSource &b) { return a.name < b.name; });
+    return corpus;
+}
+
+// Pairs `<name>.vert` with `<name>.frag`.
+inline std::vector<ShaderProgramSource> GetCorpusPrograms(const std::vector<ShaderSource> &corpus)
+{
+    std::vector<ShaderProgramSource> programs;
+    for (const ShaderSource &vertex : corpus)
+    {
+        if (vertex.type != GL_VERTEX_SHADER)
+        {
+            continue;
+        }
+        std::string stem = vertex.name.substr(0, vertex.name.rfind('.'));
+        for (const ShaderSource &fragment : corpus)
+        {
+            if (fragment.type == GL_FRAGMENT_SHADER && fragment.name == stem + ".frag")
+            {
+                programs.push_back({stem, &vertex, &fragment});
+            }
+        }
+    }
+    return programs;
+}
+
+struct TranslatorOutput
+{
+    const char *name;
+    ShShaderOutput output;
+};
+
+// The translator outputs built into libANGLE_translator for this platform. Build with
+// `translator_all_backends=yes` to get the HLSL and MSL ones everywhere.
+constexpr TranslatorOutput kTranslatorOutputs[] = {
+    {"ESSL", SH_ESSL_OUTPUT},
+    {"GLSL compatibility", SH_GLSL_COMPATIBILITY_OUTPUT},
+    {"GLSL 4.10", SH_GLSL_410_CORE_OUTPUT},
+#if defined(ANGLE_ENABLE_HLSL)
+    {"HLSL 4.1", SH_HLSL_4_1_OUTPUT},
+#endif
+#if defined(ANGLE_ENABLE_METAL)
+    {"MSL", SH_MSL_METAL_OUTPUT},
+#endif
+};
+
+// ANGLE's default resources, with the extensions and limits Godot's shaders rely on.
+inline void InitTranslatorResources(ShBuiltInResources *resources)
+{
+    sh::InitBuiltInResources(resources);
+    resources->MaxDrawBuffers           = 8;
+    resources->FragmentPrecisionHigh    = 1;
+    resources->OES_standard_derivatives = 1;
+}
+
+class Timer
+{
+  public:
+    Timer() : mStart(std::chrono::steady_clock::now()) {}
+
+    void restart() { mStart = std::chrono::steady_clock::now(); }
+
+    double elapsedMs() const
+    {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - mStart)
+            .count();
+    }
+
+  private:
+    std::chrono::steady_clock::time_point mStart;
+};
+
+inline bool HasArgument(int argc, char **argv, const char *argument)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        if (strcmp(argv[i], argument) == 0)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Returns the value of `--name=value`, or `defaultValue` when absent.
+inline std::string GetArgument(int argc, char **argv, const char *name, const char *defaultValue)
+{
+    size_t nameLength = strlen(name);
+    for (int i = 1; i < argc; ++i)
+    {
+        if (strncmp(argv[i], name, nameLength) == 0 && argv[i][nameLength] == '=')
+        {
+            return argv[i] + nameLength + 1;
+        }
+    }
+    return defaultValue;
+}
+
+struct EGLWindow
+{
+    EGLDisplay display = EGL_NO_DISPLAY;
+    EGLSurface surface = EGL_NO_SURFACE;
+    EGLContext context = EGL_NO_CONTEXT;
+};
+
+// `backend` is one of:
+//   null    - the null renderer, requires building with `renderer_null=yes`.
+//   gl_null - the GL backend with stubbed out driver entry points.
+//   native  - the backend Godot uses on this platform.
+// On Linux, where the archives are built without X11 or Wayland, the GL backends get a
+// surfaceless display from the system libEGL (EGL_MESA_platform_surfaceless), so they run
+// without a window system.
+// `enabledFeatures` is an optional null terminated list of ANGLE features to enable on the display.
+inline bool InitializeEGLWindow(const std::string &backend,
+                                EGLWindow *window,
+                                const char *const *enabledFeatures = nullptr)
+{
+    EGLAttrib platformType = EGL_PLATFORM_ANGLE_TYPE_DEFAULT_ANGLE;
+    EGLAttrib deviceType   = EGL_PLATFORM_ANGLE_DEVICE_TYPE_HARDWARE_ANGLE;
+    if (backend == "null")
+    {
+        platformType = EGL_PLATFORM_ANGLE_TYPE_NULL_ANGLE;
+    }
+    else if (backend == "gl_null")
+    {
+#if defined(_WIN32)
+        fprintf(stderr, "The gl_null backend is not built on Windows.\n");
+        return false;
+#else
+        platformType = EGL_PLATFORM_ANGLE_TYPE_OPENGL_ANGLE;
+        deviceType   = EGL_PLATFORM_ANGLE_DEVICE_TYPE_NULL_ANGLE;
+#endif
+    }
+    else if (backend == "native")
+    {
+#if defined(__linux__)
+        // Display.cpp only creates a DisplayEGL on Linux for this device type.
+        platformType = EGL_PLATFORM_ANGLE_TYPE_OPENGL_ANGLE;
+        deviceType   = EGL_PLATFORM_ANGLE_DEVICE_TYPE_EGL_ANGLE;
+#endif
+    }
+    else
+    {
+        fprintf(stderr, "Unknown backend %s.\n", backend.c_str());
+        return false;
+    }
+
+    const char *const noFeatures[]           = {nullptr};
+    std::vector<EGLAttrib> displayAttributes = {
+        EGL_PLATFORM_ANGLE_TYPE_ANGLE,
+        platformType,
+        EGL_PLATFORM_ANGLE_DEVICE_TYPE_ANGLE,
+        deviceType,
+        EGL_FEATURE_OVERRIDES_ENABLED_ANGLE,
+        reinterpret_cast<EGLAttrib>(enabledFeatures != nullptr ? enabledFeatures : noFeatures)};
+#if defined(__linux__)
+    if (platformType == EGL_PLATFORM_ANGLE_TYPE_OPENGL_ANGLE)
+    {
+        displayAttributes.push_back(EGL_PLATFORM_ANGLE_NATIVE_PLATFORM_TYPE_ANGLE);
+        displayAttributes.push_back(EGL_PLATFORM_SURFACELESS_MESA);
+    }
+#endif
+    displayAttributes.push_back(EGL_NONE);
+    window->display = eglGetPlatformDisplay(EGL_PLATFORM_ANGLE_ANGLE,
+                                            reinterpret_cast<void *>(EGL_DEFAULT_DISPLAY),
+                                            displayAttributes.data());
+    if (window->display == EGL_NO_DISPLAY || !eglInitialize(window->display, nullptr, nullptr))
+    {
+        fprintf(stderr, "Could not initialize the %s EGL display.\n", backend.c_str());
+        return false;
+    }
+
+    const EGLint configAttributes[] = {EGL_RED_SIZE,     8, EGL_GREEN_SIZE,   8,
+                                       EGL_BLUE_SIZE,    8, EGL_ALPHA_SIZE,   8,
+                                       EGL_DEPTH_SIZE,   24, EGL_STENCIL_SIZE, 8,
+                                       EGL_SURFACE_TYPE, EGL_PBUFFER_BIT, EGL_RENDERABLE_TYPE,
+                                       EGL_OPENGL_ES3_BIT, EGL_NONE};
+    EGLConfig config       = nullptr;
+    EGLint configCount     = 0;
+    if (!eglChooseConfig(window->display, configAttributes, &config, 1, &configCount) ||
+        configCount == 0)
+    {
+        fprintf(stderr, "No ES3 capable EGL config.\n");
+        return false;
+    }
+
+    const EGLint surfaceAttributes[] = {EGL_WIDTH, 256, EGL_HEIGHT, 256, EGL_NONE};
+    window->surface = eglCreatePbufferSurface(window->display, config, surfaceAttributes);
+
+    const EGLint contextAttributes[] = {EGL_CONTEXT_MAJOR_VERSION, 3, EGL_CONTEXT_MINOR_VERSION, 0,
+                                        EGL_NONE};
+    window->context = eglCreateContext(window->display, config, EGL_NO_CONTEXT, contextAttributes);
+    if (window->surface == EGL_NO_SURFACE || window->context == EGL_NO_CONTEXT ||
+        !eglMakeCurrent(window->display, window->surface, window->surface, window->context))
+    {
+        fprintf(stderr, "Could not create an ES3 context.\n");
+        return false;
+    }
+    return true;
+}
+
+inline void DestroyEGLWindow(EGLWindow *window)
+{
+    if (window->display == EGL_NO_DISPLAY)
+    {
+        return;
+    }
+    eglMakeCurrent(window->display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    if (window->context != EGL_NO_CONTEXT)
+    {
+        eglDestroyContext(window->display, window->context);
+    }
+    if (window->surface != EGL_NO_SURFACE)
+    {
+        eglDestroySurface(window->display, window->surface);
+    }
+    eglTerminate(window->display);
+    *window = EGLWindow();
+}
+
+inline GLuint CompileShader(GLenum type, const std::string &source)
+{
+    GLuint shader       = glCreateShader(type);
+    const char *strings = source.c_str();
+    glShaderSource(shader, 1, &strings, nullptr);
+    glCompileShader(shader);
+    return shader;
+}
+
+inline GLuint LinkProgram(const ShaderProgramSource &programSource)
+{
+    GLuint vertex   = CompileShader(GL_VERTEX_SHADER, programSource.vertex->source);
+    GLuint fragment = CompileShader(GL_FRAGMENT_SHADER, programSource.fragment->source);
+    GLuint program  = glCreateProgram();
+    glAttachShader(program, vertex);
+    glAttachShader(program, fragment);
+    glLinkProgram(program);
+    glDeleteShader(vertex);
+    glDeleteShader(fragment);
+
+    GLint linked = GL_FALSE;
+    glGetProgramiv(program, GL_LINK_STATUS, &linked);
+    if (!linked)
+    {
+        char log[4096] = {};
+        glGetProgramInfoLog(program, sizeof(log), nullptr, log);
+        fprintf(stderr, "Could not link %s:\n%s\n", programSource.name.c_str(), log);
+        glDeleteProgram(program);
+        return 0;
+    }
+    return program;
+}
+
+}  // namespace workloads
+
+#endif  // WORKLOADS_WORKLOAD_UTILS_H_